@@ -4,66 +4,379 @@
 #include <future>
 #include <queue>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <functional>
+#include <deque>
+#include <optional>
 #include <chrono>
 #include <iomanip>
-#include <random>
+#include <algorithm>
+#include <span>
+#include <bit>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+#include "scan_engine/scan_engine.h"
 
-// Константы
-const unsigned char TARGET_BYTE1 = 0x0a;
-const unsigned char TARGET_BYTE2 = 0x0d;
-const unsigned char TARGET_BYTE3 = 0x20;
+// Константы (целевые байты TARGET_BYTE1..3 - в scan_engine.h)
 const char* FILENAME = "input.bin";
 const size_t FILE_SIZE = 30 * 1024 * 1024;  // 30 МБ
+const size_t READ_BUFFER_SIZE = 1024 * 1024;  // буфер чтения для ifstream
+const size_t SINK_BATCH_SIZE = 4096;          // размер локальной пачки найденных байтов
+const size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;  // участок планировщика по умолчанию
+const size_t STREAM_BUFFER_SIZE = 4 * 1024 * 1024;  // буфер потокового режима
+const size_t STREAM_BUFFERS = 8;                    // число буферов в кольце потокового режима
 
-// Общая очередь
-std::queue<unsigned char> byte_queue;
-std::mutex queue_mtx;
-
-// Структура результатов
-struct CountResult {
-    int count_0a;
-    int count_0d;
-    int count_20;
-    int count_group;
-    size_t queue_size;
+// ============== Выходной канал для найденных байтов ==============
+
+// Канал, в который рабочие потоки передают найденные байты.
+// worker - номер потока-производителя (нужен каналам с отдельным кольцом на поток)
+struct IByteSink {
+    virtual void push(size_t worker, const unsigned char* bytes, size_t n) = 0;
+    virtual size_t size() = 0;   // сколько байтов принято каналом
+    virtual void finish() {}     // дождаться, пока потребитель разберёт всё записанное
+    virtual const char* name() const = 0;
+    virtual ~IByteSink() = default;
+};
+
+// Исходный вариант: общая std::queue под одним мьютексом
+struct MutexQueueSink : IByteSink {
+    std::queue<unsigned char> q;
+    std::mutex m;
+
+    void push(size_t, const unsigned char* bytes, size_t n) override {
+        std::lock_guard<std::mutex> lock(m);
+        for (size_t i = 0; i < n; ++i) {
+            q.push(bytes[i]);
+        }
+    }
+
+    size_t size() override {
+        std::lock_guard<std::mutex> lock(m);
+        return q.size();
+    }
+
+    const char* name() const override { return "mutex std::queue"; }
+};
+
+// Ограниченное lock-free кольцо MPSC с пакетной записью и потоком-потребителем.
+// Производитель резервирует диапазон через CAS, копирует пачку и публикует её
+// в порядке резервирования; потребитель читает всё опубликованное сразу.
+class MpscRingSink : public IByteSink {
+private:
+    static constexpr size_t CAPACITY = 1 << 22;  // степень двойки
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    std::vector<unsigned char> ring;
+    alignas(64) std::atomic<uint64_t> reserve_pos{0};
+    alignas(64) std::atomic<uint64_t> commit_pos{0};
+    alignas(64) std::atomic<uint64_t> read_pos{0};
+    alignas(64) std::atomic<size_t> consumed{0};
+    std::atomic<bool> stop{false};
+    std::array<size_t, 256> drained_counts{};
+    std::thread consumer;  // объявлен последним: запускается после инициализации остальных полей
+
+    void consume() {
+        uint64_t r = 0;
+        while (true) {
+            uint64_t c = commit_pos.load(std::memory_order_acquire);
+            if (c != r) {
+                for (uint64_t i = r; i < c; ++i) {
+                    ++drained_counts[ring[i & MASK]];
+                }
+                consumed.fetch_add(c - r, std::memory_order_relaxed);
+                read_pos.store(c, std::memory_order_release);
+                r = c;
+            } else if (stop.load(std::memory_order_acquire)) {
+                if (commit_pos.load(std::memory_order_acquire) == r) break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    MpscRingSink() : ring(CAPACITY), consumer([this] { consume(); }) {}
+
+    ~MpscRingSink() override { finish(); }
+
+    void push(size_t, const unsigned char* bytes, size_t n) override {
+        while (n > 0) {
+            size_t part = std::min(n, CAPACITY / 4);
+
+            uint64_t pos = reserve_pos.load(std::memory_order_relaxed);
+            while (true) {
+                if (pos + part - read_pos.load(std::memory_order_acquire) > CAPACITY) {
+                    std::this_thread::yield();  // кольцо заполнено - ждём потребителя
+                    pos = reserve_pos.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (reserve_pos.compare_exchange_weak(pos, pos + part, std::memory_order_relaxed)) break;
+            }
+
+            for (size_t i = 0; i < part; ++i) {
+                ring[(pos + i) & MASK] = bytes[i];
+            }
+
+            // Публикация строго по порядку резервирования
+            while (commit_pos.load(std::memory_order_acquire) != pos) {
+                std::this_thread::yield();
+            }
+            commit_pos.store(pos + part, std::memory_order_release);
+
+            bytes += part;
+            n -= part;
+        }
+    }
+
+    size_t size() override { return consumed.load(std::memory_order_relaxed); }
+
+    void finish() override {
+        stop.store(true, std::memory_order_release);
+        if (consumer.joinable()) consumer.join();
+    }
+
+    const char* name() const override { return "lock-free MPSC ring"; }
+};
+
+// Отдельное кольцо SPSC на каждый рабочий поток и один потребитель, обходящий кольца по кругу
+class SpscRingsSink : public IByteSink {
+private:
+    static constexpr size_t CAPACITY = 1 << 20;
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    struct Ring {
+        std::vector<unsigned char> data = std::vector<unsigned char>(CAPACITY);
+        alignas(64) std::atomic<uint64_t> head{0};  // пишет потребитель
+        alignas(64) std::atomic<uint64_t> tail{0};  // пишет производитель
+    };
+
+    std::vector<std::unique_ptr<Ring>> rings;
+    alignas(64) std::atomic<size_t> consumed{0};
+    std::atomic<bool> stop{false};
+    std::array<size_t, 256> drained_counts{};
+    std::thread consumer;
+
+    // Разбор одного кольца; возвращает, было ли что читать
+    bool drain(Ring& ring) {
+        uint64_t h = ring.head.load(std::memory_order_relaxed);
+        uint64_t t = ring.tail.load(std::memory_order_acquire);
+        if (h == t) return false;
+
+        for (uint64_t i = h; i < t; ++i) {
+            ++drained_counts[ring.data[i & MASK]];
+        }
+        consumed.fetch_add(t - h, std::memory_order_relaxed);
+        ring.head.store(t, std::memory_order_release);
+        return true;
+    }
+
+    void consume() {
+        while (true) {
+            bool stopping = stop.load(std::memory_order_acquire);
+            bool any = false;
+            for (auto& ring : rings) {
+                any |= drain(*ring);
+            }
+            if (!any) {
+                if (stopping) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    explicit SpscRingsSink(size_t producers) {
+        rings.reserve(producers);
+        for (size_t i = 0; i < producers; ++i) {
+            rings.push_back(std::make_unique<Ring>());
+        }
+        consumer = std::thread([this] { consume(); });
+    }
+
+    ~SpscRingsSink() override { finish(); }
+
+    void push(size_t worker, const unsigned char* bytes, size_t n) override {
+        Ring& ring = *rings[worker];
+        uint64_t t = ring.tail.load(std::memory_order_relaxed);
+
+        while (n > 0) {
+            uint64_t free_space = CAPACITY - (t - ring.head.load(std::memory_order_acquire));
+            if (free_space == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            size_t part = std::min<uint64_t>(n, free_space);
+            for (size_t i = 0; i < part; ++i) {
+                ring.data[(t + i) & MASK] = bytes[i];
+            }
+            t += part;
+            ring.tail.store(t, std::memory_order_release);
+
+            bytes += part;
+            n -= part;
+        }
+    }
+
+    size_t size() override { return consumed.load(std::memory_order_relaxed); }
+
+    void finish() override {
+        stop.store(true, std::memory_order_release);
+        if (consumer.joinable()) consumer.join();
+    }
+
+    const char* name() const override { return "per-thread SPSC rings"; }
+};
+
+// Локальная пачка рабочего потока: найденные байты копятся без синхронизации
+// и уходят в канал одной операцией. capacity = 1 воспроизводит запись по одному байту
+class ByteBatcher {
+private:
+    IByteSink& sink;
+    size_t worker;
+    std::vector<unsigned char> buffer;
+    size_t used = 0;
+
+public:
+    ByteBatcher(IByteSink& sink, size_t worker, size_t capacity = SINK_BATCH_SIZE)
+        : sink(sink), worker(worker), buffer(std::max<size_t>(capacity, 1)) {}
+
+    ~ByteBatcher() { flush(); }
+
+    ByteBatcher(ByteBatcher const&) = delete;
+    ByteBatcher& operator=(ByteBatcher const&) = delete;
+
+    void push(unsigned char byte) {
+        buffer[used++] = byte;
+        if (used == buffer.size()) flush();
+    }
+
+    void flush() {
+        if (used == 0) return;
+        sink.push(worker, buffer.data(), used);
+        used = 0;
+    }
 };
 
-// Генерация тестового файла
-void generate_test_file(const std::string& filename, size_t size_bytes) {
+// ============== Сканирование с передачей найденных байтов ==============
+
+// Передача найденных байтов блока в локальную пачку (порядок байтов сохраняется)
+void push_matches(const unsigned char* block, uint64_t matches, ByteBatcher& out) {
+    while (matches) {
+        out.push(block[std::countr_zero(matches)]);
+        matches &= matches - 1;
+    }
+}
+
+// Сканирование непрерывного участка (см. scan_target_bytes) с отправкой найденных байтов в out
+void scan_bytes(std::span<const unsigned char> data, CountResult& result, ByteBatcher& out) {
+    scan_target_bytes(data, result, [&](const unsigned char* block, uint64_t matches) {
+        push_matches(block, matches, out);
+    });
+}
+
+// ============== Генерация тестового файла ==============
+
+const uint64_t DEFAULT_SEED = 0x5EED;
+
+// Счётчиковый генератор SplitMix64: слово с номером index вычисляется независимо от остальных,
+// поэтому файл можно заполнять с любого места любым числом потоков с одинаковым результатом
+inline uint64_t random_word(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Заполнение участка [offset, offset + len) файла; offset кратен 8
+void fill_random(unsigned char* out, uint64_t offset, size_t len, uint64_t seed) {
+    uint64_t index = offset / sizeof(uint64_t);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word = random_word(seed, index++);
+        std::memcpy(out + i, &word, sizeof(word));
+    }
+    if (i < len) {
+        uint64_t word = random_word(seed, index);
+        std::memcpy(out + i, &word, len - i);
+    }
+}
+
+// Генерация тестового файла: каждый поток заполняет и пишет через pwrite свою область.
+// Содержимое определяется только seed и размером, но не числом потоков
+void generate_test_file(const std::string& filename, size_t size_bytes, uint64_t seed, unsigned int num_threads) {
     std::cout << "Генерация файла " << filename
-              << " размером " << (size_bytes / 1024.0 / 1024.0) << " МБ...\n";
+              << " размером " << (size_bytes / 1024.0 / 1024.0) << " МБ (seed " << seed
+              << ", потоков " << num_threads << ")...\n";
 
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+    auto start = std::chrono::steady_clock::now();
+
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(size_bytes)) != 0) {
         std::cerr << "Ошибка создания файла\n";
+        if (fd >= 0) close(fd);
         return;
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<unsigned char> dist(0, 255);
-
     const size_t BUFFER_SIZE = 1024 * 1024;
-    std::vector<unsigned char> buffer(BUFFER_SIZE);
+    const size_t num_blocks = (size_bytes + BUFFER_SIZE - 1) / BUFFER_SIZE;
+    num_threads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(num_threads, num_blocks)));
+    std::atomic<bool> failed{false};
+
+    auto writer = [&](unsigned int t) {
+        std::vector<unsigned char> buffer(BUFFER_SIZE);
 
-    size_t bytes_written = 0;
-    while (bytes_written < size_bytes) {
-        size_t chunk_size = std::min(BUFFER_SIZE, size_bytes - bytes_written);
+        for (size_t block = num_blocks * t / num_threads; block < num_blocks * (t + 1) / num_threads; ++block) {
+            uint64_t offset = block * BUFFER_SIZE;
+            size_t chunk_size = std::min<uint64_t>(BUFFER_SIZE, size_bytes - offset);
+            fill_random(buffer.data(), offset, chunk_size, seed);
 
-        for (size_t i = 0; i < chunk_size; ++i) {
-            buffer[i] = dist(gen);
+            size_t done = 0;
+            while (done < chunk_size) {
+                ssize_t written = pwrite(fd, buffer.data() + done, chunk_size - done,
+                                         static_cast<off_t>(offset + done));
+                if (written <= 0) {
+                    failed = true;
+                    return;
+                }
+                done += written;
+            }
         }
+    };
 
-        file.write(reinterpret_cast<char*>(buffer.data()), chunk_size);
-        bytes_written += chunk_size;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(writer, t);
     }
+    for (auto& th : threads) {
+        th.join();
+    }
+    close(fd);
 
-    file.close();
-    std::cout << "Файл создан успешно!\n\n";
+    if (failed) {
+        std::cerr << "Ошибка записи файла\n";
+        return;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Файл создан успешно за " << ms << " мс ("
+              << (size_bytes / 1024.0 / 1024.0) / (std::max(ms, 1e-3) / 1000.0) << " МБ/с)\n\n";
 }
 
 // Функция обработки части файла (для packaged_task)
-CountResult process_file_chunk(const std::string& filename, size_t start_pos, size_t end_pos) {
+CountResult process_file_chunk(const std::string& filename, size_t start_pos, size_t end_pos,
+                               IByteSink& sink, size_t worker) {
     CountResult result = {0, 0, 0, 0, 0};
 
     std::ifstream file(filename, std::ios::binary);
@@ -74,59 +387,628 @@ CountResult process_file_chunk(const std::string& filename, size_t start_pos, si
 
     file.seekg(start_pos);
 
-    unsigned char prev_byte = 0;
-    char byte;
-    size_t current_pos = start_pos;
+    // Чтение крупными буферами вместо file.get() по одному байту
+    std::vector<unsigned char> buffer(READ_BUFFER_SIZE);
+    ByteBatcher out(sink, worker);
+    size_t remaining = end_pos - start_pos;
+
+    while (remaining > 0 && file) {
+        size_t to_read = std::min(remaining, buffer.size());
+        file.read(reinterpret_cast<char*>(buffer.data()), to_read);
+        size_t got = file.gcount();
+        if (got == 0) break;
+
+        scan_bytes({buffer.data(), got}, result, out);
+        remaining -= got;
+    }
+
+    file.close();
+
+    out.flush();
+    result.queue_size = sink.size();
+
+    return result;
+}
 
-    while (file.get(byte) && current_pos < end_pos) {
-        unsigned char ub = static_cast<unsigned char>(byte);
+// ============== Отображение файла в память (mmap) ==============
 
-        if (ub == TARGET_BYTE1) {
-            result.count_0a++;
-            std::lock_guard<std::mutex> lock(queue_mtx);
-            byte_queue.push(ub);
+// RAII-обёртка над mmap: файл отображается один раз, потоки получают std::span на свои части
+class MappedFile {
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
         }
-        else if (ub == TARGET_BYTE2) {
-            result.count_0d++;
-            std::lock_guard<std::mutex> lock(queue_mtx);
-            byte_queue.push(ub);
+
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(addr);
+                size_ = st.st_size;
+                // Подсказки ядру: последовательное чтение и (по возможности) большие страницы
+                madvise(addr, size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+                madvise(addr, size_, MADV_HUGEPAGE);
+#endif
+            }
         }
-        else if (ub == TARGET_BYTE3) {
-            result.count_20++;
-            std::lock_guard<std::mutex> lock(queue_mtx);
-            byte_queue.push(ub);
+        close(fd);  // отображение остаётся валидным после закрытия дескриптора
+    }
+
+    ~MappedFile() {
+        if (data_) {
+            munmap(const_cast<unsigned char*>(data_), size_);
         }
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    bool is_open() const { return data_ != nullptr; }
+
+    std::span<const unsigned char> bytes() const { return {data_, size_}; }
+};
+
+// Обработка части отображённого файла (zero-copy, без собственного ifstream)
+CountResult process_mapped_chunk(std::span<const unsigned char> chunk, IByteSink& sink, size_t worker,
+                                 size_t batch_size = SINK_BATCH_SIZE) {
+    CountResult result = {0, 0, 0, 0, 0};
+
+    ByteBatcher out(sink, worker, batch_size);
+    scan_bytes(chunk, result, out);
+
+    out.flush();
+    result.queue_size = sink.size();
+
+    return result;
+}
+
+// ============== Планировщик участков с перехватом работы ==============
+
+// Очередь номеров участков одного потока: владелец берёт с начала,
+// остальные потоки при простое перехватывают работу с конца
+class WorkDeque {
+private:
+    std::deque<size_t> items;
+    std::mutex m;
 
-        // Проверка группы 0x0d0a
-        if (ub == 0x0a && prev_byte == 0x0d) {
-            result.count_group++;
+public:
+    void push(size_t item) {
+        std::lock_guard<std::mutex> lock(m);
+        items.push_back(item);
+    }
+
+    std::optional<size_t> pop() {
+        std::lock_guard<std::mutex> lock(m);
+        if (items.empty()) return std::nullopt;
+        size_t item = items.front();
+        items.pop_front();
+        return item;
+    }
+
+    std::optional<size_t> steal() {
+        std::lock_guard<std::mutex> lock(m);
+        if (items.empty()) return std::nullopt;
+        size_t item = items.back();
+        items.pop_back();
+        return item;
+    }
+};
+
+// Статистика одного рабочего потока
+struct WorkerStats {
+    size_t chunks = 0;
+    size_t stolen = 0;
+    size_t bytes = 0;
+    double busy_ms = 0;
+};
+
+struct ScanReport {
+    CountResult total = {0, 0, 0, 0, 0};
+    std::vector<WorkerStats> workers;
+    double elapsed_ms = 0;
+};
+
+// Обработка участка [begin, end) потоком worker
+using ChunkFn = std::function<CountResult(size_t worker, size_t begin, size_t end)>;
+
+// Делит [0, total_size) на участки по chunk_size и обрабатывает их на threads потоках.
+// Каждый поток сначала получает непрерывную полосу участков, а закончив её - крадёт чужие.
+// Результаты участков сводятся строго по порядку, поэтому CRLF на границах не теряются
+ScanReport run_chunked_scan(size_t total_size, unsigned int threads, size_t chunk_size, const ChunkFn& process) {
+    ScanReport report;
+    if (total_size == 0) return report;
+
+    size_t num_chunks = (total_size + chunk_size - 1) / chunk_size;
+    threads = static_cast<unsigned int>(std::min<size_t>(std::max(threads, 1u), num_chunks));
+
+    std::vector<WorkDeque> deques(threads);
+    for (size_t c = 0; c < num_chunks; ++c) {
+        deques[c * threads / num_chunks].push(c);
+    }
+
+    std::vector<CountResult> chunk_results(num_chunks);
+
+    auto worker_fn = [&](size_t worker) {
+        WorkerStats stats;
+        auto busy_start = std::chrono::steady_clock::now();
+
+        while (true) {
+            std::optional<size_t> chunk = deques[worker].pop();
+            for (size_t k = 1; !chunk && k < threads; ++k) {
+                chunk = deques[(worker + k) % threads].steal();
+                if (chunk) stats.stolen++;
+            }
+            if (!chunk) break;  // работы не осталось ни у кого
+
+            size_t begin = *chunk * chunk_size;
+            size_t end = std::min(begin + chunk_size, total_size);
+            chunk_results[*chunk] = process(worker, begin, end);
+
+            stats.chunks++;
+            stats.bytes += end - begin;
         }
 
-        prev_byte = ub;
-        current_pos++;
+        stats.busy_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - busy_start).count();
+        return stats;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Каждый рабочий поток - packaged_task, статистика возвращается через future
+    std::vector<std::future<WorkerStats>> futures;
+    std::vector<std::thread> workers;
+    for (unsigned int w = 0; w < threads; ++w) {
+        std::packaged_task<WorkerStats(size_t)> task(worker_fn);
+        futures.push_back(task.get_future());
+        workers.emplace_back(std::move(task), w);
+    }
+    for (auto& th : workers) {
+        th.join();
+    }
+
+    report.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    for (auto& f : futures) {
+        report.workers.push_back(f.get());
+    }
+    for (const auto& r : chunk_results) {
+        report.total = merge_results(report.total, r);
     }
 
-    file.close();
+    return report;
+}
 
-    {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        result.queue_size = byte_queue.size();
+void print_worker_stats(const ScanReport& report) {
+    for (size_t w = 0; w < report.workers.size(); ++w) {
+        const WorkerStats& st = report.workers[w];
+        double mb = st.bytes / 1024.0 / 1024.0;
+        std::cout << "  Поток " << std::setw(2) << w << ": участков " << std::setw(4) << st.chunks
+                  << " (украдено " << st.stolen << "), "
+                  << std::fixed << std::setprecision(1) << mb << " МБ, "
+                  << mb / (std::max(st.busy_ms, 1e-3) / 1000.0) << " МБ/с\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
     }
+}
 
-    return result;
+// ============== Параметры командной строки ==============
+
+struct Options {
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk_size = DEFAULT_CHUNK_SIZE;
+    bool bench_sinks = false;
+    bool generate = false;            // пересоздать файл, даже если он существует
+    size_t file_size = FILE_SIZE;
+    uint64_t seed = DEFAULT_SEED;
+    bool stream = false;              // читать stdin вместо файла
+    unsigned int report_ms = 1000;    // период промежуточных отчётов потокового режима
+    bool composite = false;           // однопроходный анализ несколькими ядрами scan_engine
+    std::string pattern = "\r\n";    // шаблон для ядра поиска
+};
+
+void print_usage(const char* program) {
+    std::cout << "Использование: " << program
+              << " [--threads N] [--chunk-mb M] [--bench-sinks] [--generate] [--size-mb S] [--seed X]"
+              << " [--stdin [--report-ms T]] [--composite [--pattern P]]\n"
+              << "  --threads N    число рабочих потоков (по умолчанию hardware_concurrency)\n"
+              << "  --chunk-mb M   размер участка в МБ (по умолчанию "
+              << DEFAULT_CHUNK_SIZE / 1024 / 1024 << ")\n"
+              << "  --bench-sinks  сравнение выходных каналов на 2..N потоках\n"
+              << "  --generate     пересоздать входной файл\n"
+              << "  --size-mb S    размер создаваемого файла в МБ (по умолчанию "
+              << FILE_SIZE / 1024 / 1024 << ")\n"
+              << "  --seed X       seed генератора (одинаковый seed - одинаковый файл)\n"
+              << "  --stdin        потоковый режим: читать stdin (pipe), например zcat ... | "
+              << program << " --stdin\n"
+              << "  --report-ms T  период промежуточных отчётов в мс (по умолчанию 1000)\n"
+              << "  --composite    один проход: целевые байты, гистограмма, пары байтов и поиск шаблона\n"
+              << "  --pattern P    шаблон для --composite (по умолчанию CRLF)\n";
+}
+
+std::optional<Options> parse_options(int argc, char* argv[]) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                options.threads = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--chunk-mb" && i + 1 < argc) {
+                options.chunk_size = std::max(1, std::stoi(argv[++i])) * 1024ull * 1024ull;
+            } else if (arg == "--bench-sinks") {
+                options.bench_sinks = true;
+            } else if (arg == "--generate") {
+                options.generate = true;
+            } else if (arg == "--size-mb" && i + 1 < argc) {
+                options.file_size = std::stoull(argv[++i]) * 1024ull * 1024ull;
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = std::stoull(argv[++i], nullptr, 0);
+            } else if (arg == "--stdin") {
+                options.stream = true;
+            } else if (arg == "--composite") {
+                options.composite = true;
+            } else if (arg == "--pattern" && i + 1 < argc) {
+                options.pattern = argv[++i];
+            } else if (arg == "--report-ms" && i + 1 < argc) {
+                options.report_ms = std::max(1, std::stoi(argv[++i]));
+            } else {
+                return std::nullopt;
+            }
+        }
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+// ============== Сравнение выходных каналов ==============
+
+// Один прогон: threads потоков сканируют равные части data и пишут найденные байты в sink.
+// Возвращает время в мс; ok = размер канала совпал с суммой найденных байтов
+double run_sink_test(std::span<const unsigned char> data, IByteSink& sink, unsigned int threads,
+                     size_t batch_size, bool& ok) {
+    std::vector<CountResult> results(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    size_t part = data.size() / threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < threads; ++t) {
+        size_t begin = t * part;
+        size_t len = (t + 1 == threads) ? data.size() - begin : part;
+        workers.emplace_back([&, t, begin, len] {
+            results[t] = process_mapped_chunk(data.subspan(begin, len), sink, t, batch_size);
+        });
+    }
+    for (auto& th : workers) {
+        th.join();
+    }
+    sink.finish();
+    auto end = std::chrono::steady_clock::now();
+
+    CountResult total = {0, 0, 0, 0, 0};
+    for (const auto& r : results) {
+        total = merge_results(total, r);
+    }
+    ok = sink.size() == total.count_0a + total.count_0d + total.count_20;
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Режим --bench-sinks: мьютексная очередь против пакетных lock-free каналов на 2..N потоках
+void benchmark_sinks(std::span<const unsigned char> data, unsigned int max_threads) {
+    struct SinkVariant {
+        size_t batch_size;
+        std::function<std::unique_ptr<IByteSink>(unsigned int)> make;
+    };
+
+    const std::vector<SinkVariant> variants = {
+        {1, [](unsigned int) { return std::make_unique<MutexQueueSink>(); }},
+        {SINK_BATCH_SIZE, [](unsigned int) { return std::make_unique<MutexQueueSink>(); }},
+        {SINK_BATCH_SIZE, [](unsigned int) { return std::make_unique<MpscRingSink>(); }},
+        {SINK_BATCH_SIZE, [](unsigned int threads) { return std::make_unique<SpscRingsSink>(threads); }},
+    };
+
+    max_threads = std::max(2u, max_threads);
+    double megabytes = data.size() / 1024.0 / 1024.0;
+
+    std::cout << "=== СРАВНЕНИЕ ВЫХОДНЫХ КАНАЛОВ ===\n";
+    std::cout << "Размер данных: " << megabytes << " МБ, классификатор: " << CLASSIFIER.name << "\n";
+
+    for (unsigned int threads = 2; ; threads = std::min(threads * 2, max_threads)) {
+        std::cout << "\nПотоков: " << threads << "\n";
+
+        for (const auto& variant : variants) {
+            auto sink = variant.make(threads);
+            bool ok = false;
+            double ms = run_sink_test(data, *sink, threads, variant.batch_size, ok);
+
+            std::cout << "  " << std::left << std::setw(24) << sink->name() << std::right
+                      << " пачка " << std::setw(5) << variant.batch_size
+                      << std::setw(9) << std::fixed << std::setprecision(1) << ms << " мс  "
+                      << std::setw(8) << megabytes / (ms / 1000.0) << " МБ/с  "
+                      << (ok ? "✓" : "✗ размер канала не совпал") << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+
+        if (threads == max_threads) break;
+    }
+}
+
+// ============== Потоковый режим (stdin / pipe) ==============
+
+// Буфер кольца: читатель заполняет, рабочий поток сканирует, главный поток сводит результат
+enum class SlotState { Free, Filled, Scanned };
+
+struct StreamSlot {
+    std::vector<unsigned char> data = std::vector<unsigned char>(STREAM_BUFFER_SIZE);
+    size_t size = 0;
+    SlotState state = SlotState::Free;
+    CountResult result = {0, 0, 0, 0, 0};
+};
+
+// Заполнение буфера из fd: читаем, пока данные поступают без ожидания. На живом pipe
+// (tail -f) буфер отдаётся сразу, как только новых данных нет, на быстром (zcat) - целиком.
+// Возвращает число байт; 0 - конец потока
+size_t fill_from_fd(int fd, std::vector<unsigned char>& buffer) {
+    size_t used = 0;
+    while (used < buffer.size()) {
+        if (used > 0) {
+            pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 0) <= 0) break;  // новых данных пока нет
+        }
+
+        ssize_t got = read(fd, buffer.data() + used, buffer.size() - used);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        used += got;
+    }
+    return used;
+}
+
+void print_stream_snapshot(const CountResult& total, double elapsed_s, uint64_t bytes_since_last, double interval_s) {
+    double mb = total.bytes_scanned / 1024.0 / 1024.0;
+    std::cout << "[" << std::fixed << std::setprecision(1) << std::setw(7) << elapsed_s << " с] "
+              << "LF " << total.count_0a << ", CR " << total.count_0d
+              << ", пробел " << total.count_20 << ", CRLF " << total.count_group
+              << " | " << mb << " МБ, сейчас "
+              << bytes_since_last / 1024.0 / 1024.0 / std::max(interval_s, 1e-3) << " МБ/с, в среднем "
+              << mb / std::max(elapsed_s, 1e-3) << " МБ/с\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+// Чтение fd отдельным потоком в кольцо буферов, классификация на threads рабочих потоках.
+// Результаты буферов сводятся строго по порядку, поэтому CRLF на стыке буферов учитывается
+int run_stream_mode(int fd, const Options& options) {
+    std::vector<StreamSlot> slots(STREAM_BUFFERS);
+    std::mutex m;
+    std::condition_variable cv_free, cv_filled, cv_scanned;
+
+    uint64_t next_filled = 0;   // следующий номер буфера для читателя
+    uint64_t next_to_scan = 0;  // следующий номер буфера для рабочих потоков
+    bool eof = false;
+
+    MpscRingSink sink;
+
+    std::cout << "=== ПОТОКОВЫЙ РЕЖИМ ===\n";
+    std::cout << "Буферов: " << STREAM_BUFFERS << " x " << STREAM_BUFFER_SIZE / 1024 / 1024
+              << " МБ, рабочих потоков: " << options.threads
+              << ", классификатор: " << CLASSIFIER.name << "\n";
+
+    std::thread reader([&] {
+        for (uint64_t seq = 0; ; ++seq) {
+            StreamSlot& slot = slots[seq % STREAM_BUFFERS];
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv_free.wait(lock, [&] { return slot.state == SlotState::Free; });
+            }
+
+            // Пока буфер свободен, к нему обращается только читатель
+            size_t got = fill_from_fd(fd, slot.data);
+
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (got == 0) {
+                    eof = true;
+                } else {
+                    slot.size = got;
+                    slot.state = SlotState::Filled;
+                    next_filled = seq + 1;
+                }
+            }
+            cv_filled.notify_all();
+            if (got == 0) break;
+        }
+        cv_scanned.notify_all();
+    });
+
+    std::vector<std::thread> workers;
+    for (unsigned int w = 0; w < options.threads; ++w) {
+        workers.emplace_back([&, w] {
+            ByteBatcher out(sink, w);
+            while (true) {
+                uint64_t seq;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    cv_filled.wait(lock, [&] { return next_to_scan < next_filled || eof; });
+                    if (next_to_scan >= next_filled) break;  // eof и всё роздано
+                    seq = next_to_scan++;
+                }
+
+                StreamSlot& slot = slots[seq % STREAM_BUFFERS];
+                slot.result = {0, 0, 0, 0, 0};
+                scan_bytes({slot.data.data(), slot.size}, slot.result, out);
+                out.flush();  // байты буфера должны попасть в канал до отчёта о нём
+
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    slot.state = SlotState::Scanned;
+                }
+                cv_scanned.notify_one();
+            }
+        });
+    }
+
+    // Главный поток сводит результаты по порядку и печатает промежуточные отчёты
+    CountResult total = {0, 0, 0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    uint64_t bytes_at_last_report = 0;
+    const auto interval = std::chrono::milliseconds(options.report_ms);
+
+    for (uint64_t seq = 0; ; ) {
+        StreamSlot& slot = slots[seq % STREAM_BUFFERS];
+        bool have_slot = false;
+        bool done = false;
+        CountResult slot_result;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv_scanned.wait_until(lock, last_report + interval, [&] {
+                return slot.state == SlotState::Scanned || (eof && seq == next_filled);
+            });
+            if (slot.state == SlotState::Scanned) {
+                slot_result = slot.result;
+                slot.state = SlotState::Free;
+                have_slot = true;
+            } else {
+                done = eof && seq == next_filled;
+            }
+        }
+
+        if (have_slot) {
+            cv_free.notify_one();
+            total = merge_results(total, slot_result);
+            ++seq;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= interval || done) {
+            print_stream_snapshot(total,
+                std::chrono::duration<double>(now - start).count(),
+                total.bytes_scanned - bytes_at_last_report,
+                std::chrono::duration<double>(now - last_report).count());
+            last_report = now;
+            bytes_at_last_report = total.bytes_scanned;
+        }
+        if (done) break;
+    }
+
+    reader.join();
+    for (auto& th : workers) {
+        th.join();
+    }
+    sink.finish();
+
+    std::cout << "\n--- ИТОГ ---\n";
+    std::cout << "Прочитано: " << total.bytes_scanned << " байт\n";
+    std::cout << "Количество байт 0x0a (LF): " << total.count_0a << "\n";
+    std::cout << "Количество байт 0x0d (CR): " << total.count_0d << "\n";
+    std::cout << "Количество байт 0x20 (пробел): " << total.count_20 << "\n";
+    std::cout << "Количество групп 0x0d0a (CRLF): " << total.count_group << "\n";
+
+    if (sink.size() == total.count_0a + total.count_0d + total.count_20) {
+        std::cout << "✓ Размер очереди совпадает с суммой найденных байтов\n";
+        return 0;
+    }
+    std::cout << "✗ ОШИБКА: несоответствие размера очереди!\n";
+    return 1;
+}
+
+// ============== Однопроходный анализ (scan_engine) ==============
+
+// Режим --composite: четыре ядра за одно чтение файла и перекрёстная проверка их результатов
+int run_composite_mode(const Options& options) {
+    TargetCountScan targets;
+    HistogramScan histogram;
+    BigramScan bigrams;
+    PatternScan pattern(options.pattern);
+
+    ScanStats stats;
+    auto states = run_composite_scan(FILENAME, {&targets, &histogram, &bigrams, &pattern}, options.threads, &stats);
+    if (states.empty()) {
+        return 1;
+    }
+
+    const CountResult& counts = static_cast<const TargetCountScan::State&>(*states[0]).result;
+    const auto& hist = static_cast<const HistogramScan::State&>(*states[1]).counts;
+    const auto& pairs = static_cast<const BigramScan::State&>(*states[2]).table;
+    const auto& found = static_cast<const PatternScan::State&>(*states[3]);
+
+    std::cout << "=== ОДНОПРОХОДНЫЙ АНАЛИЗ ===\n";
+    std::cout << "Ядра: " << targets.name() << ", " << histogram.name() << ", "
+              << bigrams.name() << ", " << pattern.name() << "\n";
+    std::cout << "Потоков: " << stats.threads << ", " << stats.elapsed_ms << " мс, "
+              << (stats.bytes / 1024.0 / 1024.0) / (std::max(stats.elapsed_ms, 1e-3) / 1000.0) << " МБ/с\n\n";
+
+    std::cout << "Количество байт 0x0a (LF): " << counts.count_0a << "\n";
+    std::cout << "Количество байт 0x0d (CR): " << counts.count_0d << "\n";
+    std::cout << "Количество байт 0x20 (пробел): " << counts.count_20 << "\n";
+    std::cout << "Количество групп 0x0d0a (CRLF): " << counts.count_group << "\n";
+    std::cout << "Вхождений шаблона (" << options.pattern.size() << " байт): " << found.matches << "\n";
+
+    // Самая частая пара байтов
+    size_t top_pair = std::max_element(pairs.begin(), pairs.end()) - pairs.begin();
+    std::cout << "Самая частая пара байтов: 0x" << std::hex << std::setw(4) << std::setfill('0') << top_pair
+              << std::dec << std::setfill(' ') << " (" << pairs[top_pair] << ")\n";
+
+    bool ok = hist[TARGET_BYTE1] == counts.count_0a &&
+              hist[TARGET_BYTE2] == counts.count_0d &&
+              hist[TARGET_BYTE3] == counts.count_20 &&
+              pairs[(TARGET_BYTE2 << 8) | TARGET_BYTE1] == counts.count_group;
+    if (ok) {
+        std::cout << "✓ Гистограмма и таблица пар согласуются с подсчётом целевых байтов\n";
+    } else {
+        std::cout << "✗ ОШИБКА: ядра дали несогласованные результаты!\n";
+    }
+    return ok ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    std::optional<Options> parsed = parse_options(argc, argv);
+    if (!parsed) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const Options options = *parsed;
+
+    if (options.stream) {
+        return run_stream_mode(STDIN_FILENO, options);
+    }
+
     // Проверка/создание файла
     std::ifstream check_file(FILENAME);
-    if (!check_file.good()) {
+    if (!check_file.good() || options.generate) {
         check_file.close();
-        generate_test_file(FILENAME, FILE_SIZE);
+        generate_test_file(FILENAME, options.file_size, options.seed, options.threads);
     } else {
         check_file.close();
         std::cout << "Файл существует, используем его\n\n";
     }
 
+    if (options.composite) {
+        return run_composite_mode(options);
+    }
+
+    if (options.bench_sinks) {
+        MappedFile mapped(FILENAME);
+        if (!mapped.is_open()) {
+            std::cerr << "Ошибка отображения файла в память\n";
+            return 1;
+        }
+        benchmark_sinks(mapped.bytes(), options.threads);
+        return 0;
+    }
+
     // Временные метки начала
     auto start_time = std::chrono::steady_clock::now();
     auto start_timestamp = std::chrono::system_clock::now();
@@ -150,36 +1032,24 @@ int main() {
     std::cout << "Размер файла: " << (file_size / 1024.0 / 1024.0)
               << " МБ (" << file_size << " байт)\n";
 
-    size_t mid_point = file_size / 2;
-
-    // ===== КЛЮЧЕВАЯ ЧАСТЬ: std::packaged_task =====
-
-    // Создаём packaged_task для каждой задачи
-    std::packaged_task<CountResult(const std::string&, size_t, size_t)> task1(process_file_chunk);
-    std::packaged_task<CountResult(const std::string&, size_t, size_t)> task2(process_file_chunk);
+    // ===== КЛЮЧЕВАЯ ЧАСТЬ: участки + перехват работы, потоки - std::packaged_task =====
 
-    // Получаем future из packaged_task
-    std::future<CountResult> future1 = task1.get_future();
-    std::future<CountResult> future2 = task2.get_future();
+    // Найденные байты уходят пачками в lock-free кольцо вместо мьютексной очереди
+    MpscRingSink sink;
 
-    // Запускаем потоки с packaged_task (через std::move, т.к. packaged_task не копируется)
-    std::cout << "Запуск обработки в 2 потока...\n";
-    std::thread thread1(std::move(task1), FILENAME, 0, mid_point);
-    std::thread thread2(std::move(task2), FILENAME, mid_point, file_size);
+    std::cout << "Запуск обработки: потоков " << options.threads << ", участок "
+              << options.chunk_size / 1024.0 / 1024.0 << " МБ...\n";
+    ScanReport report = run_chunked_scan(file_size, options.threads, options.chunk_size,
+        [&](size_t worker, size_t begin, size_t end) {
+            return process_file_chunk(FILENAME, begin, end, sink, worker);
+        });
+    sink.finish();
 
-    // Ждём завершения потоков
-    thread1.join();
-    thread2.join();
-
-    // Получаем результаты через future
-    CountResult result1 = future1.get();
-    CountResult result2 = future2.get();
-
-    // Суммируем результаты
-    int total_0a = result1.count_0a + result2.count_0a;
-    int total_0d = result1.count_0d + result2.count_0d;
-    int total_20 = result1.count_20 + result2.count_20;
-    int total_group = result1.count_group + result2.count_group;
+    CountResult total = report.total;
+    uint64_t total_0a = total.count_0a;
+    uint64_t total_0d = total.count_0d;
+    uint64_t total_20 = total.count_20;
+    uint64_t total_group = total.count_group;
 
     // Временные метки окончания
     auto end_time = std::chrono::steady_clock::now();
@@ -187,14 +1057,56 @@ int main() {
     auto end_time_t = std::chrono::system_clock::to_time_t(end_timestamp);
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
+    // ===== Тот же подсчёт через mmap + std::span для сравнения скорости =====
+
+    std::cout << "Запуск обработки через mmap...\n";
+    MpscRingSink mmap_sink;  // отдельный канал, чтобы проверка размера относилась к одному проходу
+
+    auto mmap_start_time = std::chrono::steady_clock::now();
+
+    MappedFile mapped(FILENAME);
+    if (!mapped.is_open()) {
+        std::cerr << "Ошибка отображения файла в память\n";
+        return 1;
+    }
+
+    std::span<const unsigned char> all_bytes = mapped.bytes();
+
+    ScanReport mmap_report = run_chunked_scan(all_bytes.size(), options.threads, options.chunk_size,
+        [&](size_t worker, size_t begin, size_t end) {
+            return process_mapped_chunk(all_bytes.subspan(begin, end - begin), mmap_sink, worker);
+        });
+    mmap_sink.finish();
+
+    auto mmap_end_time = std::chrono::steady_clock::now();
+    auto mmap_duration = std::chrono::duration_cast<std::chrono::milliseconds>(mmap_end_time - mmap_start_time);
+
+    const CountResult& mmap_total = mmap_report.total;
+    bool mmap_matches =
+        mmap_total.count_0a == total_0a &&
+        mmap_total.count_0d == total_0d &&
+        mmap_total.count_20 == total_20 &&
+        mmap_total.count_group == total_group;
+
     std::cout << "\n=== РЕЗУЛЬТАТЫ РАБОТЫ ПРОГРАММЫ ===\n";
     std::cout << "Время окончания: "
               << std::put_time(std::localtime(&end_time_t), "%Y-%m-%d %H:%M:%S")
               << std::endl;
     std::cout << "Время выполнения: " << duration.count() << " мс\n";
+    std::cout << "Классификатор байтов: " << CLASSIFIER.name << "\n";
     std::cout << "Скорость обработки: "
               << (file_size / 1024.0 / 1024.0) / (duration.count() / 1000.0)
               << " МБ/с\n";
+    std::cout << "Скорость обработки (mmap): "
+              << (file_size / 1024.0 / 1024.0) / (std::max<long long>(mmap_duration.count(), 1) / 1000.0)
+              << " МБ/с (" << mmap_duration.count() << " мс, ускорение x"
+              << static_cast<double>(duration.count()) / std::max<long long>(mmap_duration.count(), 1)
+              << ")\n";
+
+    std::cout << "\n--- ПОТОКИ (ifstream) ---\n";
+    print_worker_stats(report);
+    std::cout << "\n--- ПОТОКИ (mmap) ---\n";
+    print_worker_stats(mmap_report);
 
     std::cout << "\n--- КОЛИЧЕСТВЕННЫЕ ПОКАЗАТЕЛИ ---\n";
     std::cout << "Количество байт 0x0a (LF): " << total_0a << "\n";
@@ -202,28 +1114,33 @@ int main() {
     std::cout << "Количество байт 0x20 (пробел): " << total_20 << "\n";
     std::cout << "Количество групп 0x0d0a (CRLF): " << total_group << "\n";
 
-    {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        std::cout << "Размер очереди: " << byte_queue.size() << " элементов\n";
-    }
+    std::cout << "Размер очереди: " << sink.size() << " элементов (" << sink.name() << ")\n";
 
     // Пояснения результатов
     std::cout << "\n--- ПОЯСНЕНИЕ РЕЗУЛЬТАТОВ ---\n";
-    std::cout << "1. Файл обработан в 2 потока параллельно\n";
-    std::cout << "2. Байты 0x0a, 0x0d, 0x20 записаны в общую очередь\n";
+    std::cout << "1. Файл разбит на участки по " << options.chunk_size / 1024.0 / 1024.0
+              << " МБ и обработан в " << report.workers.size()
+              << " потоков; простаивающий поток перехватывает участки у соседей\n";
+    std::cout << "2. Байты 0x0a, 0x0d, 0x20 пачками переданы в общую очередь (lock-free кольцо)\n";
     std::cout << "3. Размер очереди = сумма найденных целевых байтов\n";
-    std::cout << "4. Группы 0x0d0a - последовательности CR+LF (перевод строки Windows)\n";
-    std::cout << "5. Для случайных данных ожидается ~117KB каждого байта (30MB/256≈117KB)\n";
+    std::cout << "4. Группы 0x0d0a - последовательности CR+LF (перевод строки Windows),\n"
+              << "   включая пары, разрезанные границами участков (результаты сводятся по порядку)\n";
+    std::cout << "5. Повторный проход через mmap: файл отображается один раз, потоки читают свои std::span\n";
+    std::cout << "6. Для случайных данных ожидается ~117KB каждого байта (30MB/256≈117KB)\n";
+    std::cout << "7. Параметры: --threads N, --chunk-mb M; сравнение каналов: --bench-sinks\n";
 
     // Проверка корректности
-    int expected_queue_size = total_0a + total_0d + total_20;
-    {
-        std::lock_guard<std::mutex> lock(queue_mtx);
-        if (byte_queue.size() == expected_queue_size) {
-            std::cout << "✓ Размер очереди совпадает с суммой найденных байтов\n";
-        } else {
-            std::cout << "✗ ОШИБКА: несоответствие размера очереди!\n";
-        }
+    uint64_t expected_queue_size = total_0a + total_0d + total_20;
+    if (sink.size() == expected_queue_size && mmap_sink.size() == expected_queue_size) {
+        std::cout << "✓ Размер очереди совпадает с суммой найденных байтов\n";
+    } else {
+        std::cout << "✗ ОШИБКА: несоответствие размера очереди!\n";
+    }
+
+    if (mmap_matches) {
+        std::cout << "✓ Результаты mmap совпадают с результатами ifstream\n";
+    } else {
+        std::cout << "✗ ОШИБКА: результаты mmap отличаются от ifstream!\n";
     }
 
     return 0;
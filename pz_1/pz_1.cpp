@@ -5,14 +5,31 @@
 #include <array>
 #include <iomanip>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "../Timer.h"
+#include "../scan_engine/scan_engine.h"
 
 constexpr size_t BUF_SIZE = 64 * 1024;
 constexpr uint32_t PATTERN_SIZE = 64 * 1024;
-constexpr long long APPEND_SIZE = 120 * 1024 * 1024;
-constexpr size_t SYMBOLS = 256;
+constexpr uint64_t APPEND_SIZE = 120 * 1024 * 1024;
+constexpr size_t WRITE_CHUNK = 16 * PATTERN_SIZE;  // 1 МБ за один pwrite
+constexpr size_t DIRECT_ALIGN = 4096;             // выравнивание для O_DIRECT
 
-std::array<unsigned long long, SYMBOLS> G_COUNTS{};
+constexpr size_t CACHE_LINE = 64;
+
+alignas(CACHE_LINE) std::array<unsigned long long, SYMBOLS> G_COUNTS{};
 
 
 void hello_thread() {
@@ -40,7 +57,7 @@ std::vector<unsigned char> createPattern() {
     return pattern;
 }
 
-void writeFileThread_direct(std::string &file_path) {
+void writeFileThread_direct(std::string &file_path, uint64_t append_size) {
     Timer timer("writeFileThread_direct");
 
     std::ofstream out(file_path, std::ios::binary | std::ios::app);
@@ -51,10 +68,10 @@ void writeFileThread_direct(std::string &file_path) {
 
     auto pattern = createPattern(); // Динамическое создание
 
-    uint32_t total_written = 0;
-    while (total_written < APPEND_SIZE) {
-        uint32_t remaining = APPEND_SIZE - total_written;
-        uint32_t write_size = std::min(static_cast<uint32_t>(pattern.size()), remaining);
+    uint64_t total_written = 0;
+    while (total_written < append_size) {
+        uint64_t remaining = append_size - total_written;
+        size_t write_size = static_cast<size_t>(std::min<uint64_t>(pattern.size(), remaining));
 
         out.write(reinterpret_cast<const char*>(pattern.data()), write_size);
         total_written += write_size;
@@ -63,10 +80,289 @@ void writeFileThread_direct(std::string &file_path) {
     out.flush();
 }
 
-std::mutex g_merge_mutex;
+// ======================== Параллельная запись (fallocate + pwrite) ========================
+
+enum class WriteMode { Stream, Pwrite, Direct };
+
+const char* writeModeName(WriteMode mode) {
+    switch (mode) {
+        case WriteMode::Stream: return "ofstream";
+        case WriteMode::Pwrite: return "fallocate + pwrite";
+        case WriteMode::Direct: return "fallocate + pwrite + O_DIRECT";
+    }
+    return "?";
+}
+
+// Запись всего буфера по смещению с дозаписью при частичном pwrite
+bool pwriteAll(int fd, const unsigned char* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t written = pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+        data += written;
+        len -= written;
+        offset += written;
+    }
+    return true;
+}
+
+// Дописывает append_size байт шаблона в конец файла несколькими потоками.
+// Место резервируется fallocate, каждый поток пишет свою непрерывную область через pwrite.
+// Шаблон начинается заново каждые PATTERN_SIZE байт от старого конца файла - так же,
+// как в writeFileThread_direct, поэтому содержимое файла не зависит от режима.
+// В режиме O_DIRECT через него идут только выровненные блоки, остальное - обычным pwrite
+bool writeFileParallel(const std::string& file_path, uint64_t append_size, unsigned int num_threads, bool use_direct) {
+    int fd = open(file_path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "Не удалось открыть файл\n";
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Не удалось узнать размер файла\n";
+        close(fd);
+        return false;
+    }
+    const uint64_t start = static_cast<uint64_t>(st.st_size);
+
+    if (append_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    if (fallocate(fd, 0, static_cast<off_t>(start), static_cast<off_t>(append_size)) != 0) {
+        // Файловая система без fallocate: хотя бы задаём итоговый размер
+        if (ftruncate(fd, static_cast<off_t>(start + append_size)) != 0) {
+            std::cerr << "Не удалось зарезервировать место в файле\n";
+            close(fd);
+            return false;
+        }
+    }
+
+    int direct_fd = -1;
+    if (use_direct) {
+        direct_fd = open(file_path.c_str(), O_WRONLY | O_DIRECT);
+        if (direct_fd < 0) {
+            std::cerr << "O_DIRECT недоступен, используется обычный pwrite\n";
+        }
+    }
+
+    // Выровненный буфер из WRITE_CHUNK / PATTERN_SIZE копий шаблона
+    std::unique_ptr<unsigned char, decltype(&std::free)> chunk(
+        static_cast<unsigned char*>(std::aligned_alloc(DIRECT_ALIGN, WRITE_CHUNK)), &std::free);
+    if (!chunk) {
+        std::cerr << "Не удалось выделить буфер записи\n";
+        if (direct_fd >= 0) close(direct_fd);
+        close(fd);
+        return false;
+    }
+    auto pattern = createPattern();
+    for (size_t off = 0; off < WRITE_CHUNK; off += PATTERN_SIZE) {
+        std::memcpy(chunk.get() + off, pattern.data(), PATTERN_SIZE);
+    }
+
+    const uint64_t num_chunks = (append_size + WRITE_CHUNK - 1) / WRITE_CHUNK;
+    num_threads = static_cast<unsigned int>(std::max<uint64_t>(1, std::min<uint64_t>(num_threads, num_chunks)));
+    std::atomic<bool> failed{false};
+
+    auto writer = [&](unsigned int t) {
+        uint64_t first = num_chunks * t / num_threads;
+        uint64_t last = num_chunks * (t + 1) / num_threads;
+
+        for (uint64_t c = first; c < last && !failed.load(std::memory_order_relaxed); ++c) {
+            uint64_t rel = c * WRITE_CHUNK;
+            size_t len = static_cast<size_t>(std::min<uint64_t>(WRITE_CHUNK, append_size - rel));
+            uint64_t offset = start + rel;
+
+            bool aligned = offset % DIRECT_ALIGN == 0 && len % DIRECT_ALIGN == 0;
+            int target = (direct_fd >= 0 && aligned) ? direct_fd : fd;
+
+            if (!pwriteAll(target, chunk.get(), len, offset)) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(writer, t);
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    if (direct_fd >= 0) close(direct_fd);
+    close(fd);
+
+    if (failed) {
+        std::cerr << "Ошибка записи pwrite\n";
+        return false;
+    }
+    return true;
+}
+
+// Запись в выбранном режиме с выводом скорости; sync - сбросить данные на диск перед замером
+bool writeFileTimed(std::string& file_path, uint64_t append_size, WriteMode mode, unsigned int num_threads, bool sync) {
+    auto start = std::chrono::steady_clock::now();
+
+    bool ok = true;
+    if (mode == WriteMode::Stream) {
+        writeFileThread_direct(file_path, append_size);
+    } else {
+        ok = writeFileParallel(file_path, append_size, num_threads, mode == WriteMode::Direct);
+    }
+
+    if (ok && sync) {
+        int fd = open(file_path.c_str(), O_WRONLY);
+        if (fd >= 0) {
+            fdatasync(fd);
+            close(fd);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Запись (" << writeModeName(mode) << "): "
+              << append_size / 1024.0 / 1024.0 / 1024.0 << " ГБ за " << seconds * 1000.0 << " мс, "
+              << append_size / 1024.0 / 1024.0 / 1024.0 / std::max(seconds, 1e-9) << " ГБ/с\n";
+    return ok;
+}
+
+// Режим --bench-write: один и тот же объём во временный файл каждым способом
+void benchmarkWriteModes(uint64_t append_size, unsigned int num_threads) {
+    std::string bench_path = "bench_write.bin";
+    std::cout << "\n=== Сравнение режимов записи (потоков: " << num_threads << ") ===\n";
+
+    for (WriteMode mode : {WriteMode::Stream, WriteMode::Pwrite, WriteMode::Direct}) {
+        std::remove(bench_path.c_str());
+        writeFileTimed(bench_path, append_size, mode, num_threads, true);
+    }
+    std::remove(bench_path.c_str());
+}
+
+// ======================== Ядра гистограммы ========================
+
+// Ядра (histogramScalar, histogramMultiTable, AVX2) и их выбор - в scan_engine
+
+// Побитовая сверка всех ядер с эталоном на случайных и на повторяющихся (createPattern) данных
+bool verifyHistogramKernels() {
+    std::vector<HistogramKernel> kernels = availableHistogramKernels();
 
-void countFilePart(const std::string& file_path, size_t offset, size_t size) {
-    std::array<uint64_t, SYMBOLS> local_counts = {0};
+    // Нечётный размер, чтобы проверить и обработку хвоста
+    constexpr size_t TEST_SIZE = 4 * 1024 * 1024 + 13;
+
+    std::vector<unsigned char> random_data(TEST_SIZE);
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> dist(0, 255);
+    for (auto& b : random_data) b = static_cast<unsigned char>(dist(gen));
+
+    std::vector<unsigned char> pattern_data;
+    pattern_data.reserve(TEST_SIZE);
+    auto pattern = createPattern();
+    while (pattern_data.size() < TEST_SIZE) {
+        size_t n = std::min(pattern.size(), TEST_SIZE - pattern_data.size());
+        pattern_data.insert(pattern_data.end(), pattern.begin(), pattern.begin() + n);
+    }
+
+    bool all_ok = true;
+    for (const auto* input : {&random_data, &pattern_data}) {
+        std::array<uint64_t, SYMBOLS> expected{};
+        histogramScalar(input->data(), input->size(), expected.data());
+
+        for (const auto& kernel : kernels) {
+            std::array<uint64_t, SYMBOLS> actual{};
+            kernel.fn(input->data(), input->size(), actual.data());
+            bool ok = actual == expected;
+            all_ok = all_ok && ok;
+            std::cout << (ok ? "✓ " : "✗ ") << kernel.name << " ("
+                      << (input == &random_data ? "случайные данные" : "повторяющийся шаблон") << ")\n";
+        }
+    }
+    return all_ok;
+}
+
+// ======================== Пул потоков подсчёта ========================
+
+// Постоянный набор потоков: повторные вызовы countFileMultithreaded не создают потоки заново.
+// run() выполняет задачу на всех потоках пула и ждёт, пока все закончат
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable cv_start;
+    std::condition_variable cv_done;
+    const std::function<void(unsigned int)>* job = nullptr;
+    uint64_t generation = 0;
+    unsigned int pending = 0;
+    bool stopping = false;
+
+    void loop(unsigned int id) {
+        uint64_t seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(m);
+            cv_start.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            const auto* task = job;
+            lock.unlock();
+
+            (*task)(id);
+
+            lock.lock();
+            if (--pending == 0) cv_done.notify_one();
+        }
+    }
+
+public:
+    explicit WorkerPool(unsigned int num_threads) {
+        for (unsigned int i = 0; i < num_threads; ++i) {
+            threads.emplace_back(&WorkerPool::loop, this, i);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv_start.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(threads.size()); }
+
+    void run(const std::function<void(unsigned int)>& task) {
+        std::unique_lock<std::mutex> lock(m);
+        job = &task;
+        pending = size();
+        ++generation;
+        cv_start.notify_all();
+        cv_done.wait(lock, [&] { return pending == 0; });
+        job = nullptr;
+    }
+};
+
+// Пул создаётся при первом вызове и пересоздаётся, только если изменилось число потоков
+WorkerPool& countingPool(unsigned int num_threads) {
+    static std::unique_ptr<WorkerPool> pool;
+    if (!pool || pool->size() != num_threads) {
+        pool.reset();
+        pool = std::make_unique<WorkerPool>(num_threads);
+    }
+    return *pool;
+}
+
+// Гистограмма потока занимает целое число кэш-линий и выровнена по их границе,
+// поэтому потоки не пишут в общие линии
+struct alignas(CACHE_LINE) PaddedHistogram {
+    std::array<uint64_t, SYMBOLS> counts{};
+};
+static_assert(sizeof(PaddedHistogram) % CACHE_LINE == 0);
+
+// Подсчёт части файла в собственную гистограмму потока (без общих данных и блокировок)
+void countFilePart(const std::string& file_path, size_t offset, size_t size, uint64_t* local_counts) {
     std::vector<unsigned char> buf(BUF_SIZE); // Динамический буфер
 
     std::ifstream in(file_path, std::ios::binary);
@@ -84,19 +380,16 @@ void countFilePart(const std::string& file_path, size_t offset, size_t size) {
         std::streamsize got = in.gcount();
         if (got == 0) break;
 
-        for (std::streamsize i = 0; i < got; ++i) {
-            ++local_counts[buf[i]];
-        }
+        HISTOGRAM_KERNEL.fn(buf.data(), static_cast<size_t>(got), local_counts);
 
         remaining -= got;
     }
-
-    std::lock_guard<std::mutex> lock(g_merge_mutex);
-    for (size_t i = 0; i < SYMBOLS; ++i) {
-        G_COUNTS[i] += local_counts[i];
-    }
 }
 
+// Подсчёт в две фазы на пуле потоков:
+// 1) каждый поток считает свою часть файла в свою PaddedHistogram;
+// 2) каждый поток суммирует по всем гистограммам свою полосу символов (кратную кэш-линии)
+//    и записывает её в G_COUNTS - полосы не пересекаются, мьютекс не нужен
 void countFileMultithreaded(const std::string& file_path, unsigned int num_threads) {
     std::ifstream in(file_path, std::ios::binary | std::ios::ate);
     if (!in) {
@@ -104,21 +397,36 @@ void countFileMultithreaded(const std::string& file_path, unsigned int num_threa
         return;
     }
 
+    num_threads = std::max(num_threads, 1u);
     size_t file_size = in.tellg();
     size_t chunk_size = (file_size + num_threads - 1) / num_threads;
 
-    std::vector<std::thread> threads;
+    WorkerPool& pool = countingPool(num_threads);
+    std::vector<PaddedHistogram> histograms(num_threads);
 
-    for (int i = 0; i < num_threads; ++i) {
-        size_t offset = i * chunk_size;
-        if (offset >= file_size) break;
+    pool.run([&](unsigned int worker) {
+        size_t offset = worker * chunk_size;
+        if (offset >= file_size) return;
 
         size_t size = std::min(chunk_size, file_size - offset);
-        threads.emplace_back(countFilePart, std::ref(file_path), offset, size);
-    }
-
-    for (auto& t : threads)
-        t.join();
+        countFilePart(file_path, offset, size, histograms[worker].counts.data());
+    });
+
+    constexpr size_t LANE = CACHE_LINE / sizeof(unsigned long long);  // символов в одной кэш-линии G_COUNTS
+    constexpr size_t LANES = SYMBOLS / LANE;
+
+    pool.run([&](unsigned int worker) {
+        size_t first = LANES * worker / num_threads * LANE;
+        size_t last = LANES * (worker + 1) / num_threads * LANE;
+
+        for (size_t s = first; s < last; ++s) {
+            uint64_t sum = 0;
+            for (const auto& h : histograms) {
+                sum += h.counts[s];
+            }
+            G_COUNTS[s] += sum;
+        }
+    });
 }
 
 
@@ -134,7 +442,42 @@ void printCounts() {
 }
 
 
-int main() {
+// Один проход scan_engine: гистограмма, CR/LF и поиск пятибайтовой группы из createPattern.
+// Гистограмма сверяется с G_COUNTS, посчитанной countFileMultithreaded
+void compositeScan(const std::string& file_path, unsigned int num_threads) {
+    auto bytes = createPattern();
+    std::string group(bytes.begin(), bytes.begin() + 5);
+
+    HistogramScan histogram;
+    TargetCountScan targets;
+    PatternScan pattern(group);
+
+    ScanStats stats;
+    auto states = run_composite_scan(file_path, {&histogram, &targets, &pattern}, num_threads, &stats);
+    if (states.empty()) return;
+
+    const auto& counts = static_cast<const HistogramScan::State&>(*states[0]).counts;
+    const CountResult& targetCounts = static_cast<const TargetCountScan::State&>(*states[1]).result;
+    uint64_t groups = static_cast<const PatternScan::State&>(*states[2]).matches;
+
+    std::cout << "\nОднопроходный анализ (" << stats.threads << " потоков, " << stats.elapsed_ms << " мс):\n";
+    std::cout << "CRLF: " << targetCounts.count_group << ", групп 0A 0D 0B 20 22: " << groups << "\n";
+
+    bool same = true;
+    for (size_t i = 0; i < SYMBOLS; ++i) {
+        same = same && counts[i] == G_COUNTS[i];
+    }
+    std::cout << (same ? "✓ Гистограмма совпадает с G_COUNTS\n" : "✗ Гистограмма расходится с G_COUNTS\n");
+}
+
+
+void printUsage(const char* program) {
+    std::cerr << "Использование: " << program
+              << " [--write-mode stream|pwrite|direct] [--size-mb N] [--bench-write] [--repeat N] [--composite]\n";
+}
+
+
+int main(int argc, char* argv[]) {
     Timer timer("main");
 
     setlocale(LC_ALL, "ru");
@@ -142,22 +485,75 @@ int main() {
     unsigned int numThreads = std::thread::hardware_concurrency();
     std::cout << "Количество аппаратных потоков: " << numThreads << std::endl;
 
+    // --write-mode stream|pwrite|direct, --size-mb N, --bench-write, --repeat N, --composite
+    WriteMode write_mode = WriteMode::Stream;
+    uint64_t append_size = APPEND_SIZE;
+    bool bench_write = false;
+    bool composite = false;
+    int repeat = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--write-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "stream") write_mode = WriteMode::Stream;
+            else if (mode == "pwrite") write_mode = WriteMode::Pwrite;
+            else if (mode == "direct") write_mode = WriteMode::Direct;
+            else {
+                std::cerr << "Неизвестный режим записи: " << mode << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--size-mb" && i + 1 < argc) {
+            append_size = std::stoull(argv[++i]) * 1024ull * 1024ull;
+        } else if (arg == "--bench-write") {
+            bench_write = true;
+        } else if (arg == "--composite") {
+            composite = true;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        }
+    }
+    unsigned int writeThreads = numThreads != 0 ? numThreads : 2;
+
+    if (bench_write) {
+        benchmarkWriteModes(append_size, writeThreads);
+        return 0;
+    }
+
     std::thread t1(hello_thread);
-    std::thread t2(writeFileThread_direct, std::ref(file_path));
+    std::thread t2(writeFileTimed, std::ref(file_path), append_size, write_mode, writeThreads, false);
 
     t1.join();
     t2.join();
    // t3.join();
-    countFileMultithreaded(file_path, std::thread::hardware_concurrency());
-
-
-    printCounts();
-}
-
-
 
+    std::cout << "Ядро гистограммы: " << HISTOGRAM_KERNEL.name << std::endl;
+    if (!verifyHistogramKernels()) {
+        std::cerr << "Ядра гистограммы расходятся с эталоном\n";
+        return 1;
+    }
 
+    countFileMultithreaded(file_path, std::thread::hardware_concurrency());
 
+    // Повторные вызовы идут на том же пуле потоков - без затрат на их создание
+    if (repeat > 1) {
+        auto expected = G_COUNTS;
+        bool same = true;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 1; r < repeat; ++r) {
+            G_COUNTS.fill(0);
+            countFileMultithreaded(file_path, std::thread::hardware_concurrency());
+            same = same && G_COUNTS == expected;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Повторных вызовов: " << repeat - 1 << ", в среднем " << ms / (repeat - 1) << " мс"
+                  << (same ? " (результаты совпадают)" : " (РЕЗУЛЬТАТЫ РАСХОДЯТСЯ)") << std::endl;
+    }
 
 
+    printCounts();
 
+    if (composite) {
+        compositeScan(file_path, std::max(numThreads, 1u));
+    }
+}
@@ -0,0 +1,883 @@
+#ifndef PZ2_PARALLEL_ALGORITHMS_H
+#define PZ2_PARALLEL_ALGORITHMS_H
+
+// Параллельные алгоритмы pz_2: parallel_accumulate, семейство reduce,
+// префиксные суммы, сортировка, слияние и поиск с ранним выходом.
+// Все алгоритмы делят диапазон на непрерывные блоки по числу потоков,
+// выбранному моделью стоимости, и сводят результаты блоков по порядку
+
+#include <thread>
+#include <vector>
+#include <array>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <barrier>
+#include <cstdint>
+#include <atomic>
+
+// ======================== Модель стоимости =============================
+
+// Параметры, измеряемые один раз при старте
+struct parallel_cost_model
+{
+    double thread_spawn_ns;    // запуск + join одного потока
+};
+
+inline double calibrate_thread_spawn_ns()
+{
+    int const samples = 64;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; ++i)
+    {
+        std::thread t([] {});
+        t.join();
+    }
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / samples;
+}
+
+inline parallel_cost_model const& cost_model()
+{
+    static parallel_cost_model const model{ calibrate_thread_spawn_ns() };
+    return model;
+}
+
+// Стоимость одного элемента для ядра run_sample(sample) -> результат.
+// Замер делается один раз на тип SampleFn: лямбда, объявленная внутри шаблона
+// алгоритма, уникальна для каждой его специализации. Выборка повторяется,
+// пока замер не станет заметно больше погрешности таймера
+template<typename SampleFn>
+double sampled_cost_ns(SampleFn run_sample, unsigned long sample)
+{
+    static double const cost = [&] {
+        unsigned long processed = 0;
+        auto start = std::chrono::steady_clock::now();
+        double elapsed_ns = 0;
+        do
+        {
+            auto sink = run_sample();
+            asm volatile("" : : "g"(&sink) : "memory");    // не даём компилятору выбросить замер
+            processed += sample;
+            elapsed_ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count();
+        } while (elapsed_ns < 20000.0);
+
+        return std::max(elapsed_ns / processed, 0.01);
+    }();
+    return cost;
+}
+
+// Число потоков, минимизирующее оценку времени T(p) = work / p + (p - 1) * spawn.
+// Минимум достигается при p = sqrt(work / spawn); 1 означает последовательное выполнение
+inline unsigned long choose_num_threads(unsigned long length, double cost_ns)
+{
+    double const work_ns = length * cost_ns;
+    double const spawn_ns = cost_model().thread_spawn_ns;
+
+    // hardware_concurrency() читает sysfs на каждом вызове - запоминаем один раз
+    static unsigned long const hardware_threads =
+        std::thread::hardware_concurrency();
+    unsigned long const max_threads = hardware_threads != 0 ? hardware_threads : 2;
+
+    auto estimate = [&](unsigned long p) { return work_ns / p + (p - 1) * spawn_ns; };
+
+    unsigned long const ideal = static_cast<unsigned long>(std::sqrt(work_ns / spawn_ns));
+    unsigned long best = 1;
+    for (unsigned long p : { ideal, ideal + 1 })
+    {
+        p = std::clamp<unsigned long>(p, 1, std::min(max_threads, length));
+        if (estimate(p) < estimate(best))
+            best = p;
+    }
+    return best;
+}
+
+// ======================== parallel_accumulate =============================
+
+template<typename Iterator, typename T>
+struct accumulate_block {
+    void operator()(Iterator first, Iterator last, T& result)
+    {
+        result = std::accumulate(first, last, result);
+    }
+};
+
+// Стоимость одного элемента accumulate_block для данной пары Iterator/T,
+// по выборке из начала диапазона
+template<typename Iterator, typename T>
+double element_cost_ns(Iterator first, unsigned long length)
+{
+    unsigned long const sample = std::min<unsigned long>(length, 4096);
+    Iterator last = first;
+    std::advance(last, sample);
+
+    return sampled_cost_ns([first, last] {
+        T result = T();
+        accumulate_block<Iterator, T>()(first, last, result);
+        return result;
+    }, sample);
+}
+
+template<typename Iterator, typename T>
+T parallel_accumulate(Iterator first, Iterator last, T init)
+{
+    unsigned long const length = std::distance(first, last);
+    if (!length)
+        return init;
+
+    // Ниже точки безубыточности создание потоков дороже самой работы
+    unsigned long const num_threads =
+        choose_num_threads(length, element_cost_ns<Iterator, T>(first, length));
+
+    if (num_threads == 1)
+        return std::accumulate(first, last, init);
+
+    unsigned long const block_size = length / num_threads;
+
+    std::vector<T> results(num_threads);
+    std::vector<std::thread> threads(num_threads - 1);
+
+    Iterator block_start = first;
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+    {
+        Iterator block_end = block_start;
+        std::advance(block_end, block_size);
+        threads[i] = std::thread(
+            accumulate_block<Iterator, T>(),
+            block_start, block_end, std::ref(results[i])
+        );
+        block_start = block_end;
+    }
+
+    accumulate_block<Iterator, T>()(block_start, last, results[num_threads - 1]);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    return std::accumulate(results.begin(), results.end(), init);
+}
+
+// ======================== parallel_accumulate: детерминированный режим =============================
+
+// У parallel_accumulate границы блоков зависят от num_threads, поэтому сумма
+// double меняется от машины к машине. Здесь диапазон режется на блоки
+// фиксированного размера, а суммы блоков сводятся фиксированным попарным
+// деревом - результат зависит только от данных, но не от числа потоков
+constexpr unsigned long DETERMINISTIC_BLOCK = 4096;
+
+enum class compensation
+{
+    none,
+    kahan,
+    neumaier,
+};
+
+// Сумма с накопленной поправкой: значение = sum + error
+template<typename T>
+struct compensated_sum
+{
+    T sum;
+    T error;
+};
+
+// Точная сумма двух чисел (TwoSum): a + b = s + e без округления
+template<typename T>
+compensated_sum<T> combine_compensated(compensated_sum<T> l, compensated_sum<T> r)
+{
+    T const s = l.sum + r.sum;
+    T const bb = s - l.sum;
+    T const e = (l.sum - (s - bb)) + (r.sum - bb);
+    return { s, l.error + r.error + e };
+}
+
+template<typename Iterator, typename T>
+compensated_sum<T> deterministic_block_sum(Iterator first, Iterator last, compensation mode)
+{
+    T sum = T();
+    T error = T();
+    switch (mode)
+    {
+    case compensation::none:
+        for (; first != last; ++first)
+            sum += *first;
+        break;
+    case compensation::kahan:
+        // c - потерянная младшая часть с обратным знаком
+        for (; first != last; ++first)
+        {
+            T const y = static_cast<T>(*first) - error;
+            T const t = sum + y;
+            error = (t - sum) - y;
+            sum = t;
+        }
+        error = -error;
+        break;
+    case compensation::neumaier:
+        // В отличие от Кэхэна, не теряет поправку, когда слагаемое больше суммы
+        for (; first != last; ++first)
+        {
+            T const x = *first;
+            T const t = sum + x;
+            if (std::abs(sum) >= std::abs(x))
+                error += (sum - t) + x;
+            else
+                error += (x - t) + sum;
+            sum = t;
+        }
+        break;
+    }
+    return { sum, error };
+}
+
+// num_threads = 0 - выбрать по модели стоимости; результат от него не зависит
+template<typename Iterator, typename T>
+T parallel_accumulate_deterministic(Iterator first, Iterator last, T init,
+                                    compensation mode = compensation::none,
+                                    unsigned long num_threads = 0)
+{
+    unsigned long const length = std::distance(first, last);
+    if (!length)
+        return init;
+
+    unsigned long const num_blocks = (length + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    if (num_threads == 0)
+        num_threads = choose_num_threads(length, element_cost_ns<Iterator, T>(first, length));
+    num_threads = std::min(num_threads, num_blocks);
+
+    std::vector<compensated_sum<T>> sums(num_blocks);
+
+    // Поток получает непрерывный диапазон блоков; каждый блок пишет в свою ячейку
+    auto run_blocks = [&](unsigned long block_first, unsigned long block_last) {
+        Iterator it = first;
+        std::advance(it, block_first * DETERMINISTIC_BLOCK);
+        for (unsigned long b = block_first; b < block_last; ++b)
+        {
+            unsigned long const n = std::min(DETERMINISTIC_BLOCK, length - b * DETERMINISTIC_BLOCK);
+            Iterator block_end = it;
+            std::advance(block_end, n);
+            sums[b] = deterministic_block_sum<Iterator, T>(it, block_end, mode);
+            it = block_end;
+        }
+    };
+
+    unsigned long const blocks_per_thread = num_blocks / num_threads;
+    std::vector<std::thread> threads(num_threads - 1);
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+        threads[i] = std::thread(run_blocks, i * blocks_per_thread, (i + 1) * blocks_per_thread);
+
+    run_blocks((num_threads - 1) * blocks_per_thread, num_blocks);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    // Попарное дерево: форма зависит только от num_blocks
+    bool const compensated = mode != compensation::none;
+    for (unsigned long width = 1; width < num_blocks; width *= 2)
+        for (unsigned long i = 0; i + width < num_blocks; i += 2 * width)
+            sums[i] = compensated
+                ? combine_compensated(sums[i], sums[i + width])
+                : compensated_sum<T>{ sums[i].sum + sums[i + width].sum, T() };
+
+    if (!compensated)
+        return init + sums[0].sum;
+
+    compensated_sum<T> const total = combine_compensated(compensated_sum<T>{ init, T() }, sums[0]);
+    return total.sum + total.error;
+}
+
+// ======================== parallel_transform_reduce =============================
+
+// Как и у std::reduce, операция reduce должна быть ассоциативной и коммутативной:
+// порядок свёртки внутри блока и между блоками не фиксирован
+
+// Число независимых аккумуляторов блочного ядра. Каждый аккумулятор -
+// отдельная цепочка зависимостей, поэтому сложения с задержкой в несколько
+// тактов идут конвейером, а массив lanes компилятор сворачивает в SIMD-регистры
+constexpr std::size_t REDUCE_LANES = 8;
+
+template<typename Iterator, typename T>
+constexpr bool use_unrolled_reduce =
+    std::is_arithmetic_v<T> &&
+    std::is_base_of_v<std::random_access_iterator_tag,
+                      typename std::iterator_traits<Iterator>::iterator_category>;
+
+template<typename Iterator, typename T, typename BinaryOp, typename UnaryOp>
+T transform_reduce_block(Iterator first, Iterator last, T init,
+                         BinaryOp reduce, UnaryOp transform)
+{
+    if constexpr (use_unrolled_reduce<Iterator, T>)
+    {
+        auto const length = last - first;
+        decltype(last - first) i = 0;
+
+        // Нейтральный элемент у пользовательской операции неизвестен, поэтому
+        // аккумуляторы начинаются с первых REDUCE_LANES элементов
+        if (length >= static_cast<decltype(length)>(2 * REDUCE_LANES))
+        {
+            std::array<T, REDUCE_LANES> lanes;
+            for (std::size_t k = 0; k < REDUCE_LANES; ++k)
+                lanes[k] = static_cast<T>(transform(first[k]));
+            i = REDUCE_LANES;
+
+            for (; i + static_cast<decltype(i)>(REDUCE_LANES) <= length; i += REDUCE_LANES)
+                for (std::size_t k = 0; k < REDUCE_LANES; ++k)
+                    lanes[k] = reduce(lanes[k], static_cast<T>(transform(first[i + k])));
+
+            // Попарная свёртка lanes: 8 -> 4 -> 2 -> 1
+            for (std::size_t width = REDUCE_LANES / 2; width > 0; width /= 2)
+                for (std::size_t k = 0; k < width; ++k)
+                    lanes[k] = reduce(lanes[k], lanes[k + width]);
+
+            init = reduce(init, lanes[0]);
+        }
+
+        for (; i < length; ++i)
+            init = reduce(init, static_cast<T>(transform(first[i])));
+        return init;
+    }
+    else
+    {
+        for (; first != last; ++first)
+            init = reduce(init, static_cast<T>(transform(*first)));
+        return init;
+    }
+}
+
+template<typename Iterator, typename T, typename BinaryOp, typename UnaryOp>
+T parallel_transform_reduce(Iterator first, Iterator last, T init,
+                            BinaryOp reduce, UnaryOp transform)
+{
+    unsigned long const length = std::distance(first, last);
+    if (!length)
+        return init;
+
+    unsigned long const sample = std::min<unsigned long>(length, 4096);
+    Iterator sample_last = first;
+    std::advance(sample_last, sample);
+
+    // Первый элемент выборки служит начальным значением, чтобы не требовать T()
+    double const cost_ns = sampled_cost_ns([=] {
+        Iterator next = first;
+        ++next;
+        return transform_reduce_block(next, sample_last,
+                                      static_cast<T>(transform(*first)), reduce, transform);
+    }, sample);
+
+    unsigned long const num_threads = choose_num_threads(length, cost_ns);
+    if (num_threads == 1)
+        return transform_reduce_block(first, last, init, reduce, transform);
+
+    unsigned long const block_size = length / num_threads;
+
+    // Каждый блок начинает с собственного первого элемента - нейтральный
+    // элемент операции не нужен, а init учитывается ровно один раз в конце
+    std::vector<T> results(num_threads);
+    std::vector<std::thread> threads(num_threads - 1);
+
+    auto run_block = [&reduce, &transform](Iterator block_first, Iterator block_last, T& result) {
+        T const head = static_cast<T>(transform(*block_first));
+        ++block_first;
+        result = transform_reduce_block(block_first, block_last, head, reduce, transform);
+    };
+
+    Iterator block_start = first;
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+    {
+        Iterator block_end = block_start;
+        std::advance(block_end, block_size);
+        threads[i] = std::thread(run_block, block_start, block_end, std::ref(results[i]));
+        block_start = block_end;
+    }
+
+    run_block(block_start, last, results[num_threads - 1]);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    for (T const& r : results)
+        init = reduce(init, r);
+    return init;
+}
+
+// ======================== parallel_reduce / parallel_count_if =============================
+
+template<typename Iterator, typename T, typename BinaryOp>
+T parallel_reduce(Iterator first, Iterator last, T init, BinaryOp reduce)
+{
+    return parallel_transform_reduce(first, last, init, reduce, std::identity());
+}
+
+template<typename Iterator, typename T>
+T parallel_reduce(Iterator first, Iterator last, T init)
+{
+    return parallel_reduce(first, last, init, std::plus<>());
+}
+
+// Предикат превращается в 0/1 и суммируется тем же блочным ядром
+template<typename Iterator, typename Predicate>
+typename std::iterator_traits<Iterator>::difference_type
+parallel_count_if(Iterator first, Iterator last, Predicate pred)
+{
+    using count_t = typename std::iterator_traits<Iterator>::difference_type;
+    return parallel_transform_reduce(first, last, count_t(0), std::plus<>(),
+        [pred](auto const& value) -> count_t { return pred(value) ? 1 : 0; });
+}
+
+// ======================== parallel_inclusive_scan / parallel_exclusive_scan =============================
+
+// Двухпроходная схема: (1) каждый блок сворачивается в сумму, (2) один поток
+// на барьере превращает суммы блоков в переносы, (3) каждый блок заново
+// сканируется от своего переноса. Операция должна быть только ассоциативной -
+// внутри блока элементы обходятся строго слева направо, поэтому блочное ядро
+// с REDUCE_LANES аккумуляторами здесь не годится.
+// Выход должен допускать std::advance (как минимум forward iterator);
+// d_first == first разрешён, как и у std::inclusive_scan
+
+// Общий каркас: scan_block(block_first, block_last, block_out, carry, has_carry)
+template<typename Iterator, typename OutIterator, typename T, typename BinaryOp, typename ScanBlock>
+OutIterator parallel_scan_blocks(Iterator first, Iterator last, OutIterator d_first,
+                                 BinaryOp op, ScanBlock scan_block,
+                                 T const* init)
+{
+    unsigned long const length = std::distance(first, last);
+    if (!length)
+        return d_first;
+
+    unsigned long const sample = std::min<unsigned long>(length, 4096);
+    Iterator sample_last = first;
+    std::advance(sample_last, sample);
+
+    // Оба прохода читают каждый элемент - стоимость элемента удваивается
+    double const cost_ns = 2 * sampled_cost_ns([=] {
+        Iterator next = first;
+        ++next;
+        return std::accumulate(next, sample_last, static_cast<T>(*first), op);
+    }, sample);
+
+    OutIterator d_last = d_first;
+    std::advance(d_last, length);
+
+    unsigned long const num_threads = choose_num_threads(length, cost_ns);
+    if (num_threads == 1)
+    {
+        scan_block(first, last, d_first, init ? *init : T(), init != nullptr);
+        return d_last;
+    }
+
+    unsigned long const block_size = length / num_threads;
+
+    std::vector<Iterator> starts(num_threads + 1);
+    std::vector<OutIterator> outputs(num_threads);
+    starts[0] = first;
+    outputs[0] = d_first;
+    for (unsigned long i = 1; i < num_threads; ++i)
+    {
+        starts[i] = starts[i - 1];
+        std::advance(starts[i], block_size);
+        outputs[i] = outputs[i - 1];
+        std::advance(outputs[i], block_size);
+    }
+    starts[num_threads] = last;
+
+    // Блоки непустые: num_threads <= length
+    std::vector<T> sums(num_threads);
+    std::vector<T> carries(num_threads);
+
+    // Переносы считаются один раз, последним пришедшим на барьер потоком
+    auto compute_carries = [&]() noexcept {
+        T carry = init ? op(*init, sums[0]) : sums[0];
+        for (unsigned long i = 1; i < num_threads; ++i)
+        {
+            carries[i] = carry;
+            carry = op(carry, sums[i]);
+        }
+        if (init)
+            carries[0] = *init;
+    };
+    std::barrier sync(static_cast<std::ptrdiff_t>(num_threads), compute_carries);
+
+    auto run_block = [&](unsigned long i) {
+        Iterator next = starts[i];
+        ++next;
+        sums[i] = std::accumulate(next, starts[i + 1], static_cast<T>(*starts[i]), op);
+
+        sync.arrive_and_wait();
+
+        bool const has_carry = i > 0 || init != nullptr;
+        scan_block(starts[i], starts[i + 1], outputs[i], carries[i], has_carry);
+    };
+
+    std::vector<std::thread> threads(num_threads - 1);
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+        threads[i] = std::thread(run_block, i);
+
+    run_block(num_threads - 1);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    return d_last;
+}
+
+template<typename Iterator, typename OutIterator, typename BinaryOp>
+OutIterator parallel_inclusive_scan(Iterator first, Iterator last, OutIterator d_first, BinaryOp op)
+{
+    using T = typename std::iterator_traits<Iterator>::value_type;
+
+    auto scan_block = [&op](Iterator block_first, Iterator block_last, OutIterator out,
+                            T carry, bool has_carry) {
+        if (!has_carry)
+        {
+            carry = *block_first;
+            *out = carry;
+            ++block_first;
+            ++out;
+        }
+        for (; block_first != block_last; ++block_first, ++out)
+        {
+            carry = op(carry, *block_first);
+            *out = carry;
+        }
+    };
+    return parallel_scan_blocks<Iterator, OutIterator, T>(first, last, d_first, op, scan_block, nullptr);
+}
+
+template<typename Iterator, typename OutIterator>
+OutIterator parallel_inclusive_scan(Iterator first, Iterator last, OutIterator d_first)
+{
+    return parallel_inclusive_scan(first, last, d_first, std::plus<>());
+}
+
+// Элемент i результата - свёртка init и элементов [0, i); сам элемент i не входит
+template<typename Iterator, typename OutIterator, typename T, typename BinaryOp>
+OutIterator parallel_exclusive_scan(Iterator first, Iterator last, OutIterator d_first,
+                                    T init, BinaryOp op)
+{
+    auto scan_block = [&op](Iterator block_first, Iterator block_last, OutIterator out,
+                            T carry, bool) {
+        for (; block_first != block_last; ++block_first, ++out)
+        {
+            // Сначала читаем вход: при d_first == first запись затирает его
+            T const value = *block_first;
+            *out = carry;
+            carry = op(carry, value);
+        }
+    };
+    return parallel_scan_blocks<Iterator, OutIterator, T>(first, last, d_first, op, scan_block, &init);
+}
+
+template<typename Iterator, typename OutIterator, typename T>
+OutIterator parallel_exclusive_scan(Iterator first, Iterator last, OutIterator d_first, T init)
+{
+    return parallel_exclusive_scan(first, last, d_first, init, std::plus<>());
+}
+
+// ======================== parallel_sort (sample sort) =============================
+
+// Выборка на один бакет: чем больше, тем ровнее бакеты
+constexpr unsigned long SORT_OVERSAMPLE = 32;
+
+// Сортировка выборкой: p потоков = p бакетов.
+// (1) каждый поток раскладывает свой кусок входа по бакетам и считает их размеры,
+// (2) на барьере размеры превращаются в смещения во временном буфере,
+// (3) поток переносит свои элементы в буфер, (4) поток b сортирует бакет b
+// на месте и возвращает его во вход. Тип элемента должен быть
+// default-constructible и перемещаемым; сортировка не стабильна, как std::sort
+template<typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+
+    unsigned long const length = last - first;
+    if (length < 2)
+        return;
+
+    // Стоимость сортировки растёт как log n - пересчитываем замер по выборке
+    unsigned long const sample = std::min<unsigned long>(length, 4096);
+    double const cost_ns = sampled_cost_ns([=] {
+        std::vector<T> copy(first, first + sample);
+        std::sort(copy.begin(), copy.end(), comp);
+        return copy.size();
+    }, sample) * std::log2(static_cast<double>(length)) / std::log2(static_cast<double>(sample));
+
+    unsigned long const num_threads = choose_num_threads(length, cost_ns);
+    if (num_threads == 1)
+    {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    unsigned long const buckets = num_threads;
+
+    // Разделители - каждый SORT_OVERSAMPLE-й элемент отсортированной равномерной выборки
+    unsigned long const sample_count = std::min(length, buckets * SORT_OVERSAMPLE);
+    std::vector<T> samples;
+    samples.reserve(sample_count);
+    for (unsigned long i = 0; i < sample_count; ++i)
+        samples.push_back(first[i * length / sample_count]);
+    std::sort(samples.begin(), samples.end(), comp);
+
+    std::vector<T> splitters;
+    splitters.reserve(buckets - 1);
+    for (unsigned long b = 1; b < buckets; ++b)
+        splitters.push_back(samples[b * sample_count / buckets]);
+
+    unsigned long const chunk = length / num_threads;
+    auto chunk_begin = [&](unsigned long t) { return t * chunk; };
+    auto chunk_end = [&](unsigned long t) { return t + 1 == num_threads ? length : (t + 1) * chunk; };
+
+    std::vector<uint32_t> bucket_of(length);
+    std::vector<unsigned long> offsets(num_threads * buckets, 0);     // [поток][бакет]
+    std::vector<unsigned long> bucket_start(buckets + 1, 0);
+    std::vector<T> buffer(length);
+
+    // Бакет элемента i. Ключ, равный разделителям splitters[lo..hi-1], может лежать
+    // в любом из бакетов lo..hi - порядок между ними не нарушится. Такие ключи
+    // раскладываются по этим бакетам по позиции во входе, иначе при частых
+    // повторах (или всех равных ключах) почти всё досталось бы одному потоку
+    auto bucket_index = [&](unsigned long i) {
+        auto const upper = std::upper_bound(splitters.begin(), splitters.end(), first[i], comp);
+        unsigned long const hi = static_cast<unsigned long>(upper - splitters.begin());
+        if (hi == 0 || comp(splitters[hi - 1], first[i]))
+            return static_cast<uint32_t>(hi);
+        unsigned long const lo = static_cast<unsigned long>(
+            std::lower_bound(splitters.begin(), upper, first[i], comp) - splitters.begin());
+        return static_cast<uint32_t>(lo + i * (hi - lo + 1) / length);
+    };
+
+    auto compute_offsets = [&]() noexcept {
+        unsigned long offset = 0;
+        for (unsigned long b = 0; b < buckets; ++b)
+        {
+            bucket_start[b] = offset;
+            for (unsigned long t = 0; t < num_threads; ++t)
+            {
+                unsigned long const count = offsets[t * buckets + b];
+                offsets[t * buckets + b] = offset;
+                offset += count;
+            }
+        }
+        bucket_start[buckets] = offset;
+    };
+    bool offsets_ready = false;
+    std::barrier sync(static_cast<std::ptrdiff_t>(num_threads), [&]() noexcept {
+        if (!offsets_ready)
+        {
+            compute_offsets();
+            offsets_ready = true;
+        }
+    });
+
+    auto run = [&](unsigned long t) {
+        unsigned long* const my_offsets = &offsets[t * buckets];
+        for (unsigned long i = chunk_begin(t); i < chunk_end(t); ++i)
+        {
+            uint32_t const b = bucket_index(i);
+            bucket_of[i] = b;
+            ++my_offsets[b];
+        }
+
+        sync.arrive_and_wait();
+
+        for (unsigned long i = chunk_begin(t); i < chunk_end(t); ++i)
+            buffer[my_offsets[bucket_of[i]]++] = std::move(first[i]);
+
+        sync.arrive_and_wait();
+
+        auto const bucket_first = buffer.begin() + bucket_start[t];
+        auto const bucket_last = buffer.begin() + bucket_start[t + 1];
+        std::sort(bucket_first, bucket_last, comp);
+        std::move(bucket_first, bucket_last, first + bucket_start[t]);
+    };
+
+    std::vector<std::thread> threads(num_threads - 1);
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+        threads[i] = std::thread(run, i);
+
+    run(num_threads - 1);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+}
+
+template<typename RandomIt>
+void parallel_sort(RandomIt first, RandomIt last)
+{
+    parallel_sort(first, last, std::less<>());
+}
+
+// ======================== parallel_merge =============================
+
+// Сколько элементов первой последовательности входит в первые k элементов
+// результата std::merge (merge path). При равенстве раньше идёт элемент из first1,
+// поэтому слияние по кускам остаётся стабильным
+template<typename RandomIt1, typename RandomIt2, typename Compare>
+unsigned long merge_path_split(RandomIt1 first1, unsigned long n1,
+                               RandomIt2 first2, unsigned long n2,
+                               unsigned long k, Compare comp)
+{
+    unsigned long lo = k > n2 ? k - n2 : 0;
+    unsigned long hi = std::min(k, n1);
+    while (lo < hi)
+    {
+        unsigned long const i = lo + (hi - lo) / 2;
+        unsigned long const j = k - i;
+        // first1[i] не больше first2[j - 1] - он должен попасть в префикс
+        if (j > 0 && !comp(first2[j - 1], first1[i]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+// Выход делится на num_threads равных кусков; границы во входах ищутся
+// бинарным поиском, после чего каждый поток делает обычный std::merge
+template<typename RandomIt1, typename RandomIt2, typename OutRandomIt, typename Compare>
+OutRandomIt parallel_merge(RandomIt1 first1, RandomIt1 last1,
+                           RandomIt2 first2, RandomIt2 last2,
+                           OutRandomIt d_first, Compare comp)
+{
+    unsigned long const n1 = last1 - first1;
+    unsigned long const n2 = last2 - first2;
+    unsigned long const length = n1 + n2;
+    if (!length)
+        return d_first;
+
+    using T = typename std::iterator_traits<RandomIt1>::value_type;
+    unsigned long const half = std::min<unsigned long>(std::min(n1, n2), 2048);
+    double const cost_ns = half == 0 ? 1.0 : sampled_cost_ns([=] {
+        std::vector<T> out(2 * half);
+        std::merge(first1, first1 + half, first2, first2 + half, out.begin(), comp);
+        return out.size();
+    }, 2 * half);
+
+    unsigned long const num_threads = choose_num_threads(length, cost_ns);
+    if (num_threads == 1)
+        return std::merge(first1, last1, first2, last2, d_first, comp);
+
+    unsigned long const block_size = length / num_threads;
+
+    auto run_block = [&](unsigned long t) {
+        unsigned long const k_begin = t * block_size;
+        unsigned long const k_end = t + 1 == num_threads ? length : (t + 1) * block_size;
+        unsigned long const i_begin = merge_path_split(first1, n1, first2, n2, k_begin, comp);
+        unsigned long const i_end = merge_path_split(first1, n1, first2, n2, k_end, comp);
+        std::merge(first1 + i_begin, first1 + i_end,
+                   first2 + (k_begin - i_begin), first2 + (k_end - i_end),
+                   d_first + k_begin, comp);
+    };
+
+    std::vector<std::thread> threads(num_threads - 1);
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+        threads[i] = std::thread(run_block, i);
+
+    run_block(num_threads - 1);
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    return d_first + length;
+}
+
+template<typename RandomIt1, typename RandomIt2, typename OutRandomIt>
+OutRandomIt parallel_merge(RandomIt1 first1, RandomIt1 last1,
+                           RandomIt2 first2, RandomIt2 last2, OutRandomIt d_first)
+{
+    return parallel_merge(first1, last1, first2, last2, d_first, std::less<>());
+}
+
+// ======================== parallel_find_if / any_of / all_of =============================
+
+// Порция, которую поток забирает за раз. Между порциями поток сверяется
+// с лучшим найденным индексом, так что лишняя работа после находки не больше
+// одной порции на поток
+constexpr unsigned long FIND_CHUNK = 4096;
+
+// Порции раздаются по возрастанию через общий счётчик, поэтому все потоки
+// движутся от начала диапазона вместе и совпадение на позиции k находится
+// примерно за k / p элементов. Найденный индекс публикуется как минимум в best;
+// поток бросает работу, как только его порция лежит правее best.
+// num_threads = 0 - выбрать по модели стоимости
+template<typename RandomIt, typename Predicate>
+RandomIt parallel_find_if(RandomIt first, RandomIt last, Predicate pred,
+                          unsigned long num_threads = 0)
+{
+    unsigned long const length = last - first;
+    if (!length)
+        return last;
+
+    // Модель оценивает худший случай - просмотр всего диапазона
+    if (num_threads == 0)
+    {
+        unsigned long const sample = std::min<unsigned long>(length, 4096);
+        double const cost_ns = sampled_cost_ns([=] {
+            return std::find_if(first, first + sample, pred) - first;
+        }, sample);
+        num_threads = choose_num_threads(length, cost_ns);
+    }
+    if (num_threads == 1)
+        return std::find_if(first, last, pred);
+
+    std::atomic<unsigned long> next_chunk{ 0 };
+    std::atomic<unsigned long> best{ length };
+
+    auto worker = [&] {
+        for (;;)
+        {
+            unsigned long const begin = next_chunk.fetch_add(1, std::memory_order_relaxed) * FIND_CHUNK;
+            // Порции выдаются по возрастанию: если эта правее best, то и все следующие
+            if (begin >= length || begin >= best.load(std::memory_order_relaxed))
+                return;
+
+            unsigned long const end = std::min(length, begin + FIND_CHUNK);
+            RandomIt const found = std::find_if(first + begin, first + end, pred);
+            if (found != first + end)
+            {
+                unsigned long index = found - first;
+                unsigned long current = best.load(std::memory_order_relaxed);
+                while (index < current &&
+                       !best.compare_exchange_weak(current, index, std::memory_order_relaxed))
+                {
+                }
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads(num_threads - 1);
+    for (unsigned long i = 0; i < (num_threads - 1); ++i)
+        threads[i] = std::thread(worker);
+
+    worker();
+
+    std::for_each(threads.begin(), threads.end(),
+        std::mem_fn(&std::thread::join));
+
+    // join упорядочивает все записи best - relaxed здесь достаточно
+    return first + best.load(std::memory_order_relaxed);
+}
+
+template<typename RandomIt, typename Predicate>
+bool parallel_any_of(RandomIt first, RandomIt last, Predicate pred,
+                     unsigned long num_threads = 0)
+{
+    return parallel_find_if(first, last, pred, num_threads) != last;
+}
+
+// Ищем первый контрпример; его отсутствие означает "все удовлетворяют"
+template<typename RandomIt, typename Predicate>
+bool parallel_all_of(RandomIt first, RandomIt last, Predicate pred,
+                     unsigned long num_threads = 0)
+{
+    return parallel_find_if(first, last,
+        [&pred](auto const& value) { return !pred(value); }, num_threads) == last;
+}
+
+#endif // PZ2_PARALLEL_ALGORITHMS_H
@@ -4,6 +4,15 @@
 #include <numeric>
 #include <algorithm>
 #include <functional>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <cstdint>
+#include <bit>
+#include <execution>
+
+#include "parallel_algorithms.h"
 
 using namespace std;
 
@@ -27,16 +36,9 @@ public:
 
 // ======================== parallel_accumulate =============================
 
+// Прежний вариант с фиксированным min_per_thread = 25 - для сравнения в бенчмарке
 template<typename Iterator, typename T>
-struct accumulate_block {
-    void operator()(Iterator first, Iterator last, T& result)
-    {
-        result = std::accumulate(first, last, result);
-    }
-};
-
-template<typename Iterator, typename T>
-T parallel_accumulate(Iterator first, Iterator last, T init)
+T parallel_accumulate_fixed_grain(Iterator first, Iterator last, T init)
 {
     unsigned long const length = std::distance(first, last);
     if (!length)
@@ -77,10 +79,445 @@ T parallel_accumulate(Iterator first, Iterator last, T init)
     return std::accumulate(results.begin(), results.end(), init);
 }
 
+// ======================== Бенчмарк: точка безубыточности =============================
+
+// Среднее время одного вызова f в мкс
+template<typename F>
+double time_us(F&& f, int reps)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r)
+        f();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+void benchmark_grain_size()
+{
+    cout << "\n=== Точка безубыточности parallel_accumulate ===\n";
+
+    vector<long long> data(10'000'000);
+    iota(data.begin(), data.end(), 1);
+
+    double const spawn_ns = cost_model().thread_spawn_ns;
+    double const cost_ns = element_cost_ns<vector<long long>::iterator, long long>(data.begin(), data.size());
+    cout << "Запуск потока: " << spawn_ns << " нс, элемент: " << cost_ns << " нс\n";
+    cout << "Оценка точки безубыточности (2 потока): ~"
+         << static_cast<unsigned long>(2 * spawn_ns / cost_ns) << " элементов\n\n";
+
+    cout << "Время одного вызова, мкс:\n";
+    cout << setw(10) << "N" << setw(16) << "std::accumulate" << setw(16) << "min_per_thread"
+         << setw(16) << "adaptive" << setw(10) << "threads" << "\n";
+
+    long long volatile keep = 0;
+    for (size_t n = 100; n <= data.size(); n *= 10)
+    {
+        int const reps = static_cast<int>(std::clamp<size_t>(1'000'000 / n, 3, 1000));
+        auto first = data.begin();
+        auto last = data.begin() + n;
+
+        double serial_us = time_us([&] { keep = std::accumulate(first, last, 0LL); }, reps);
+        double fixed_us = time_us([&] { keep = parallel_accumulate_fixed_grain(first, last, 0LL); }, reps);
+        double adaptive_us = time_us([&] { keep = parallel_accumulate(first, last, 0LL); }, reps);
+
+        cout << setw(10) << n << fixed << setprecision(1)
+             << setw(16) << serial_us << setw(16) << fixed_us << setw(16) << adaptive_us
+             << setw(10) << choose_num_threads(n, cost_ns) << "\n";
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+}
+
+// ======================== Бенчмарк: семейство reduce =============================
+
+// Строка таблицы: последовательный эталон, parallel_accumulate (если применим),
+// наш алгоритм и стандартная библиотека с std::execution::par_unseq
+template<typename R, typename Serial, typename Ours, typename Std>
+void reduce_row(char const* name, int reps, Serial serial, double accumulate_ms,
+                Ours ours, Std std_par)
+{
+    R expected{}, got{}, got_std{};
+    double const serial_ms = time_us([&] { expected = serial(); }, reps) / 1000.0;
+    double const ours_ms = time_us([&] { got = ours(); }, reps) / 1000.0;
+    double const std_ms = time_us([&] { got_std = std_par(); }, reps) / 1000.0;
+
+    // Порядок свёртки у параллельных версий другой - для double сравниваем с допуском
+    auto same = [&](R value) {
+        if constexpr (is_floating_point_v<R>)
+            return std::abs(value - expected) <= 1e-9 * std::abs(expected);
+        else
+            return value == expected;
+    };
+
+    cout << setw(16) << name << fixed << setprecision(2)
+         << setw(12) << serial_ms;
+    if (accumulate_ms >= 0)
+        cout << setw(12) << accumulate_ms;
+    else
+        cout << setw(12) << "-";
+    cout << setw(12) << ours_ms << setw(12) << std_ms
+         << setw(8) << (same(got) && same(got_std) ? "ok" : "FAIL") << "\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+void benchmark_reduce()
+{
+    cout << "\n=== parallel_reduce / transform_reduce / count_if ===\n";
+
+    size_t const n = 20'000'000;
+    int const reps = 5;
+
+    vector<double> values(n);
+    vector<int> ints(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        values[i] = 1.0 / static_cast<double>(i % 1000 + 1);
+        ints[i] = static_cast<int>((i * 2654435761u) >> 7);
+    }
+    cout << "N = " << n << ", время одного вызова, мс\n";
+
+    cout << setw(16) << "op" << setw(12) << "serial" << setw(12) << "accumulate"
+         << setw(12) << "parallel" << setw(12) << "par_unseq" << setw(8) << "check" << "\n";
+
+    double accumulate_ms = time_us([&] {
+        double volatile keep = parallel_accumulate(values.begin(), values.end(), 0.0);
+        (void)keep;
+    }, reps) / 1000.0;
+
+    reduce_row<double>("sum", reps,
+        [&] { return std::accumulate(values.begin(), values.end(), 0.0); },
+        accumulate_ms,
+        [&] { return parallel_reduce(values.begin(), values.end(), 0.0); },
+        [&] { return std::reduce(std::execution::par_unseq, values.begin(), values.end(), 0.0); });
+
+    auto square = [](double x) { return x * x; };
+    reduce_row<double>("sum of squares", reps,
+        [&] { return std::transform_reduce(values.begin(), values.end(), 0.0, std::plus<>(), square); },
+        -1,
+        [&] { return parallel_transform_reduce(values.begin(), values.end(), 0.0, std::plus<>(), square); },
+        [&] { return std::transform_reduce(std::execution::par_unseq, values.begin(), values.end(),
+                                           0.0, std::plus<>(), square); });
+
+    auto max_op = [](int a, int b) { return std::max(a, b); };
+    reduce_row<int>("max", reps,
+        [&] { return std::reduce(ints.begin(), ints.end(), ints[0], max_op); },
+        -1,
+        [&] { return parallel_reduce(ints.begin(), ints.end(), ints[0], max_op); },
+        [&] { return std::reduce(std::execution::par_unseq, ints.begin(), ints.end(), ints[0], max_op); });
+
+    auto is_even = [](int x) { return (x & 1) == 0; };
+    reduce_row<long>("count_if even", reps,
+        [&] { return static_cast<long>(std::count_if(ints.begin(), ints.end(), is_even)); },
+        -1,
+        [&] { return static_cast<long>(parallel_count_if(ints.begin(), ints.end(), is_even)); },
+        [&] { return static_cast<long>(std::count_if(std::execution::par_unseq, ints.begin(), ints.end(), is_even)); });
+}
+
+// ======================== Бенчмарк: детерминированная сумма =============================
+
+void benchmark_deterministic_accumulate()
+{
+    cout << "\n=== parallel_accumulate_deterministic ===\n";
+
+    // Слагаемые разного порядка и знака - сумма double чувствительна к порядку
+    size_t const n = 10'000'000;
+    vector<double> values(n);
+    uint64_t x = 0x5EED;
+    for (size_t i = 0; i < n; ++i)
+    {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        double const mantissa = static_cast<double>(x >> 11) / static_cast<double>(1ull << 53);
+        values[i] = (x & 1 ? -1.0 : 1.0) * mantissa * std::pow(10.0, static_cast<int>((x >> 1) % 12) - 4);
+    }
+
+    long double exact = 0;
+    for (double v : values)
+        exact += v;
+
+    unsigned long const max_threads = std::max(2u, 2 * std::thread::hardware_concurrency());
+    int const reps = 5;
+
+    struct row { char const* name; compensation mode; };
+    cout << setw(12) << "mode" << setw(12) << "ms" << setw(14) << "rel. error"
+         << setw(20) << "bit-identical 1.." << max_threads << "\n";
+
+    // Эталон скорости - обычный parallel_accumulate
+    double sum_fast = 0;
+    double const fast_ms = time_us([&] { sum_fast = parallel_accumulate(values.begin(), values.end(), 0.0); }, reps) / 1000.0;
+    cout << setw(12) << "accumulate" << fixed << setprecision(2) << setw(12) << fast_ms
+         << scientific << setprecision(2) << setw(14)
+         << static_cast<double>(std::abs((sum_fast - exact) / exact)) << setw(20) << "-" << "\n";
+
+    for (row const& r : { row{ "none", compensation::none },
+                          row{ "kahan", compensation::kahan },
+                          row{ "neumaier", compensation::neumaier } })
+    {
+        double sum = 0;
+        double const ms = time_us([&] {
+            sum = parallel_accumulate_deterministic(values.begin(), values.end(), 0.0, r.mode);
+        }, reps) / 1000.0;
+
+        // Побитовое сравнение результатов для каждого числа потоков
+        bool identical = true;
+        for (unsigned long t = 1; t <= max_threads; ++t)
+        {
+            double const s = parallel_accumulate_deterministic(values.begin(), values.end(), 0.0, r.mode, t);
+            identical = identical && std::bit_cast<uint64_t>(s) == std::bit_cast<uint64_t>(sum);
+        }
+
+        cout << setw(12) << r.name << fixed << setprecision(2) << setw(12) << ms
+             << scientific << setprecision(2) << setw(14)
+             << static_cast<double>(std::abs((sum - exact) / exact))
+             << setw(20) << (identical ? "yes" : "NO") << "\n";
+    }
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+// ======================== Проверка: префиксные суммы =============================
+
+// Композиция аффинных отображений x -> a * x + b по модулю 2^64: ассоциативна,
+// но не коммутативна, поэтому ловит любую перестановку блоков или элементов
+struct affine_map
+{
+    uint64_t a, b;
+    bool operator==(affine_map const&) const = default;
+};
+
+// Сначала l, затем r
+inline affine_map compose(affine_map l, affine_map r)
+{
+    return { r.a * l.a, r.a * l.b + r.b };
+}
+
+// Сверка держит три вектора long long и три вектора affine_map - около 72 байт
+// на элемент; выше этого размера только замеряется время (16 байт на элемент)
+size_t const SCAN_CHECK_MAX = 100'000'000;
+
+// Сравнивает четыре варианта со std::inclusive_scan / std::exclusive_scan
+// на размере n; возвращает true, если все совпали
+bool check_scans(size_t n)
+{
+    vector<long long> data(n);
+    vector<affine_map> maps(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t const x = i * 0x9E3779B97F4A7C15ull;
+        data[i] = static_cast<long long>(x >> 40) - (1LL << 23);
+        maps[i] = { (x >> 32) | 1, x & 0xFFFF };
+    }
+
+    vector<long long> expected(n), got(n);
+    bool ok = true;
+
+    std::inclusive_scan(data.begin(), data.end(), expected.begin());
+    parallel_inclusive_scan(data.begin(), data.end(), got.begin());
+    ok = ok && got == expected;
+
+    std::exclusive_scan(data.begin(), data.end(), expected.begin(), 42LL);
+    parallel_exclusive_scan(data.begin(), data.end(), got.begin(), 42LL);
+    ok = ok && got == expected;
+
+    vector<affine_map> expected_maps(n), got_maps(n);
+    affine_map const identity{ 1, 0 };
+
+    std::inclusive_scan(maps.begin(), maps.end(), expected_maps.begin(), compose);
+    parallel_inclusive_scan(maps.begin(), maps.end(), got_maps.begin(), compose);
+    ok = ok && got_maps == expected_maps;
+
+    std::exclusive_scan(maps.begin(), maps.end(), expected_maps.begin(), identity, compose);
+    parallel_exclusive_scan(maps.begin(), maps.end(), got_maps.begin(), identity, compose);
+    ok = ok && got_maps == expected_maps;
+
+    // На месте: d_first == first
+    expected = data;
+    std::inclusive_scan(expected.begin(), expected.end(), expected.begin());
+    parallel_inclusive_scan(data.begin(), data.end(), data.begin());
+    ok = ok && data == expected;
+
+    return ok;
+}
+
+void benchmark_scans(size_t max_n)
+{
+    cout << "\n=== parallel_inclusive_scan / parallel_exclusive_scan ===\n";
+
+    bool all_ok = true;
+    cout << "Сверка со std::inclusive_scan / std::exclusive_scan:";
+    for (size_t n : { 0, 1, 2, 3, 7, 64, 1000, 4097, 100'000 })
+        all_ok = check_scans(n) && all_ok;
+    size_t const check_max = std::min(max_n, SCAN_CHECK_MAX);
+    for (size_t n = 1'000'000; n <= check_max; n *= 10)
+        all_ok = check_scans(n) && all_ok;
+    cout << (all_ok ? " ok" : " FAIL") << " (до N = " << check_max << ")\n";
+
+    vector<long long> data(max_n), out(max_n);
+    iota(data.begin(), data.end(), 0);
+    int const reps = 3;
+
+    double serial_us = time_us([&] { std::inclusive_scan(data.begin(), data.end(), out.begin()); }, reps);
+    double parallel_us = time_us([&] { parallel_inclusive_scan(data.begin(), data.end(), out.begin()); }, reps);
+    cout << "inclusive_scan, N = " << max_n << ": std " << fixed << setprecision(2)
+         << serial_us / 1000.0 << " мс, parallel " << parallel_us / 1000.0 << " мс\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// ======================== Бенчмарк: сортировка и слияние =============================
+
+// Запись результата сканирования: сортируем по смещению, payload только переносится
+struct scan_record
+{
+    uint64_t offset;
+    uint32_t worker;
+    uint32_t length;
+};
+
+void benchmark_sort(size_t max_n)
+{
+    cout << "\n=== parallel_sort / parallel_merge ===\n";
+    cout << "Время одного вызова, мс\n";
+    cout << setw(12) << "N" << setw(8) << "keys" << setw(12) << "std::sort" << setw(12) << "sort(par)"
+         << setw(12) << "parallel" << setw(12) << "std::merge" << setw(12) << "par. merge"
+         << setw(8) << "check" << "\n";
+
+    auto by_offset = [](scan_record const& l, scan_record const& r) { return l.offset < r.offset; };
+
+    // Число различных ключей: 0 - все разные, иначе много повторов
+    size_t const key_counts[] = { 0, 16, 1 };
+
+    for (size_t n = 1'000'000; n <= max_n; n *= 10)
+    for (size_t keys : key_counts)
+    {
+        vector<scan_record> input(n);
+        uint64_t x = n;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            uint64_t const key = keys == 0 ? x >> 24 : (x >> 24) % keys;
+            input[i] = { key, static_cast<uint32_t>(i % 64), static_cast<uint32_t>(i) };
+        }
+
+        vector<scan_record> expected = input, got_par = input, got = input;
+        int const reps = 1;
+
+        double const serial_us = time_us([&] { std::sort(expected.begin(), expected.end(), by_offset); }, reps);
+        double const std_par_us = time_us([&] {
+            std::sort(std::execution::par, got_par.begin(), got_par.end(), by_offset);
+        }, reps);
+        double const ours_us = time_us([&] { parallel_sort(got.begin(), got.end(), by_offset); }, reps);
+
+        // Сортировка нестабильна - сравниваем последовательность ключей
+        auto same_keys = [&](vector<scan_record> const& v) {
+            return std::equal(v.begin(), v.end(), expected.begin(), expected.end(),
+                [](scan_record const& l, scan_record const& r) { return l.offset == r.offset; });
+        };
+        bool ok = same_keys(got) && same_keys(got_par);
+
+        // Слияние двух отсортированных половин; std::merge стабилен, parallel_merge тоже
+        vector<scan_record> left(expected.begin(), expected.begin() + n / 3);
+        vector<scan_record> right(expected.begin() + n / 3, expected.end());
+        std::sort(left.begin(), left.end(), by_offset);
+        std::sort(right.begin(), right.end(), by_offset);
+        vector<scan_record> merged(n), merged_par(n);
+
+        double const merge_us = time_us([&] {
+            std::merge(left.begin(), left.end(), right.begin(), right.end(), merged.begin(), by_offset);
+        }, reps);
+        double const merge_par_us = time_us([&] {
+            parallel_merge(left.begin(), left.end(), right.begin(), right.end(), merged_par.begin(), by_offset);
+        }, reps);
+        ok = ok && std::equal(merged.begin(), merged.end(), merged_par.begin(),
+            [](scan_record const& l, scan_record const& r) { return l.offset == r.offset && l.length == r.length; });
+
+        cout << setw(12) << n << setw(8) << (keys == 0 ? string("all") : to_string(keys))
+             << fixed << setprecision(1)
+             << setw(12) << serial_us / 1000.0 << setw(12) << std_par_us / 1000.0
+             << setw(12) << ours_us / 1000.0 << setw(12) << merge_us / 1000.0
+             << setw(12) << merge_par_us / 1000.0 << setw(8) << (ok ? "ok" : "FAIL") << "\n";
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+}
+
+// ======================== Бенчмарк: поиск с ранним выходом =============================
+
+void benchmark_find()
+{
+    cout << "\n=== parallel_find_if / any_of / all_of ===\n";
+
+    size_t const n = 20'000'000;
+    vector<int> data(n, 0);
+    auto is_bad = [](int x) { return x < 0; };
+
+    unsigned long const hw = std::max(1u, std::thread::hardware_concurrency());
+    vector<unsigned long> thread_counts;
+    for (unsigned long t = 1; t <= 2 * hw; t *= 2)
+        thread_counts.push_back(t);
+
+    cout << "Время до первого совпадения, мкс (N = " << n << ")\n";
+    cout << setw(12) << "match at" << setw(12) << "std";
+    for (unsigned long t : thread_counts)
+        cout << setw(10) << ("p=" + to_string(t));
+    cout << setw(8) << "check" << "\n";
+
+    // Доля диапазона до плохой записи; 1.0 - совпадения нет
+    for (double position : { 0.0001, 0.01, 0.1, 0.5, 1.0 })
+    {
+        size_t const index = static_cast<size_t>(position * n);
+        if (index < n)
+            data[index] = -1;
+
+        int const reps = 5;
+        auto expected = data.begin();
+        double const std_us = time_us([&] { expected = std::find_if(data.begin(), data.end(), is_bad); }, reps);
+
+        bool ok = true;
+        cout << setw(12) << (index < n ? to_string(index) : string("none"))
+             << fixed << setprecision(0) << setw(12) << std_us;
+        for (unsigned long t : thread_counts)
+        {
+            auto found = data.begin();
+            double const us = time_us([&] { found = parallel_find_if(data.begin(), data.end(), is_bad, t); }, reps);
+            ok = ok && found == expected
+                    && parallel_any_of(data.begin(), data.end(), is_bad, t) == (index < n)
+                    && parallel_all_of(data.begin(), data.end(), [](int x) { return x >= 0; }, t) == (index >= n);
+            cout << setw(10) << us;
+        }
+        cout << setw(8) << (ok ? "ok" : "FAIL") << "\n";
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+
+        if (index < n)
+            data[index] = 0;
+    }
+}
+
 // ======================== main() =============================
 
-int main()
+int main(int argc, char* argv[])
 {
+    // pz_2 [--scan-max N] [--sort-max N] - верхние размеры бенчмарков префиксных
+    // сумм и сортировки. Сверка сканов идёт до min(N, SCAN_CHECK_MAX); замер
+    // скана берёт 16 байт на элемент, сортировка - порядка 160 байт (копии и буферы),
+    // так что 10^9 для сортировки на обычной машине не поместится в память
+    size_t scan_max = 10'000'000;
+    size_t sort_max = 10'000'000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string const arg = argv[i];
+        if (arg == "--scan-max" && i + 1 < argc)
+            scan_max = stoull(argv[++i]);
+        else if (arg == "--sort-max" && i + 1 < argc)
+            sort_max = stoull(argv[++i]);
+        else
+        {
+            cerr << "Использование: " << argv[0] << " [--scan-max N] [--sort-max N]\n";
+            return 1;
+        }
+    }
+
     cout << "=== Определение количества потоков (ядер) ===\n";
     unsigned int cores = std::thread::hardware_concurrency();
     cout << "Количество доступных аппаратных потоков: " << cores << "\n\n";
@@ -110,6 +547,13 @@ int main()
     int result = parallel_accumulate(numbers.begin(), numbers.end(), 0);
     cout << "Сумма элементов (parallel_accumulate): " << result << "\n";
 
+    benchmark_grain_size();
+    benchmark_reduce();
+    benchmark_deterministic_accumulate();
+    benchmark_scans(scan_max);
+    benchmark_sort(sort_max);
+    benchmark_find();
+
     cout << "\nПрограмма завершена.\n";
     return 0;
 }
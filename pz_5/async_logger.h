@@ -0,0 +1,186 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// ======================= АСИНХРОННЫЙ ЛОГГЕР С ДВОЙНОЙ БУФЕРИЗАЦИЕЙ =================
+//
+// Производители дописывают строки в frontBuffer под мьютексом - только memcpy,
+// никакого ввода-вывода. Поток логгера просыпается по объёму (flushBytes) или
+// по таймеру (flushInterval), за O(1) меняет frontBuffer и backBuffer местами
+// и пишет весь backBuffer одним write() уже без мьютекса.
+// Если диск не успевает и во frontBuffer накопилось maxPendingBytes,
+// производители ждут следующей смены буферов - память не растёт без предела.
+// Ошибка write() не выходит из потока логгера: она запоминается (errno),
+// дальнейшие пакеты отбрасываются, а о сбое сообщают stop() и writeError()
+
+class AsyncFileLogger
+{
+public:
+    struct Config
+    {
+        size_t flushBytes = 64 * 1024;
+        size_t maxPendingBytes = 4 * 1024 * 1024;
+        std::chrono::milliseconds flushInterval{ 50 };
+    };
+
+    explicit AsyncFileLogger(const std::string& path)
+        : AsyncFileLogger(path, Config{})
+    {
+    }
+
+    AsyncFileLogger(const std::string& path, Config config)
+        : cfg(config)
+    {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+
+        // Ёмкость резервируется заранее: append под мьютексом не перевыделяет память
+        frontBuffer.reserve(cfg.maxPendingBytes + cfg.flushBytes);
+        backBuffer.reserve(cfg.maxPendingBytes + cfg.flushBytes);
+
+        worker = std::thread(&AsyncFileLogger::flushLoop, this);
+    }
+
+    AsyncFileLogger(const AsyncFileLogger&) = delete;
+    AsyncFileLogger& operator=(const AsyncFileLogger&) = delete;
+
+    ~AsyncFileLogger()
+    {
+        stop();
+        ::close(fd);
+    }
+
+    // Дописывает строку и перевод строки; после stop() записи отбрасываются
+    void log(std::string_view line)
+    {
+        append(line.data(), line.size(), true);
+    }
+
+    // Дописывает байты как есть - для двоичных записей фиксированного размера
+    void append(const void* data, size_t size, bool newline = false)
+    {
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        spaceAvailable.wait(lock, [&] { return frontBuffer.size() < cfg.maxPendingBytes || stopping; });
+        if (stopping)
+            return;
+
+        frontBuffer.append(static_cast<const char*>(data), size);
+        if (newline)
+            frontBuffer.push_back('\n');
+
+        if (frontBuffer.size() >= cfg.flushBytes)
+        {
+            lock.unlock();
+            dataReady.notify_one();
+        }
+    }
+
+    // Дописывает всё накопленное и завершает поток логгера; повторный вызов безопасен.
+    // false - какой-то пакет не удалось записать (причина - writeError())
+    bool stop()
+    {
+        bool first = false;
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            first = !stopping;
+            stopping = true;
+        }
+        if (first)
+        {
+            dataReady.notify_one();
+            spaceAvailable.notify_all();
+            worker.join();
+        }
+        return writeError() == 0;
+    }
+
+    // errno первой неудачной записи или 0
+    int writeError() const { return writeErrno.load(std::memory_order_acquire); }
+
+    size_t bytesWritten() const { return written.load(std::memory_order_relaxed); }
+    size_t batchesWritten() const { return batches.load(std::memory_order_relaxed); }
+
+private:
+    void flushLoop()
+    {
+        for (;;)
+        {
+            bool last = false;
+            {
+                std::unique_lock<std::mutex> lock(bufferMutex);
+                dataReady.wait_for(lock, cfg.flushInterval,
+                                   [&] { return frontBuffer.size() >= cfg.flushBytes || stopping; });
+                last = stopping;
+                frontBuffer.swap(backBuffer);      // O(1): меняются только указатели
+            }
+            spaceAvailable.notify_all();
+
+            // После ошибки пакеты отбрасываются, но смена буферов продолжается -
+            // производители, ждущие места, не зависают
+            if (!backBuffer.empty() && writeError() == 0)
+            {
+                int error = writeAll(backBuffer.data(), backBuffer.size());
+                if (error != 0)
+                {
+                    writeErrno.store(error, std::memory_order_release);
+                }
+                else
+                {
+                    written.fetch_add(backBuffer.size(), std::memory_order_relaxed);
+                    batches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            backBuffer.clear();                    // ёмкость сохраняется
+
+            if (last)
+                return;
+        }
+    }
+
+    // Возвращает 0 или errno; исключений нет - они завершили бы процесс
+    int writeAll(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return errno;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return 0;
+    }
+
+    Config cfg;
+    int fd = -1;
+
+    std::mutex bufferMutex;
+    std::condition_variable dataReady;        // логгеру: набрался flushBytes или stop()
+    std::condition_variable spaceAvailable;   // производителям: буферы сменились
+    std::string frontBuffer;                  // сюда пишут производители
+    std::string backBuffer;                   // отсюда пишет логгер
+    bool stopping = false;
+
+    std::atomic<int> writeErrno{ 0 };
+    std::atomic<size_t> written{ 0 };
+    std::atomic<size_t> batches{ 0 };
+
+    std::thread worker;
+};
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <string>
+
+#include "log_record.h"
+
+// Офлайн-декодер двоичного лога pz_5: pz_5_decoder output.bin [output.txt]
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Использование: " << argv[0] << " <log.bin> [log.txt]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argc == 3 ? argv[2] : input + ".txt";
+
+    try
+    {
+        size_t count = decodeLogFile(input, output);
+        std::cout << "Декодировано " << count << " записей -> " << output << "\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
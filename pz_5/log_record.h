@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// ======================= ДВОИЧНАЯ ЗАПИСЬ ЛОГА ==================================
+//
+// Производитель не форматирует текст: он копирует в буфер логгера запись
+// фиксированного размера. Текст строится потом - при чтении файла
+// (decodeLogFile, утилита pz_5_decoder)
+
+struct LogRecord
+{
+    uint64_t timestampNs;   // steady_clock, нс
+    uint32_t threadId;
+    uint32_t value;
+};
+static_assert(sizeof(LogRecord) == 16, "LogRecord is written to disk as is");
+
+// Заголовок файла: по нему декодер отличает двоичный лог от текстового
+constexpr char LOG_MAGIC[8] = { 'P', 'Z', '5', 'L', 'O', 'G', '1', '\0' };
+
+inline LogRecord makeLogRecord(uint32_t threadId, uint32_t value)
+{
+    using namespace std::chrono;
+    return LogRecord{
+        static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count()),
+        threadId, value };
+}
+
+// Тот же текст, что строил writerThread, плюс отметка времени
+inline void formatLogRecord(const LogRecord& r, std::string& out)
+{
+    out += '[';
+    out += std::to_string(r.timestampNs);
+    out += "] Thread ";
+    out += std::to_string(r.threadId);
+    out += " -> value ";
+    out += std::to_string(r.value);
+    out += '\n';
+}
+
+// Переводит двоичный лог в текст; возвращает число записей
+inline size_t decodeLogFile(const std::string& binaryPath, const std::string& textPath)
+{
+    std::ifstream in(binaryPath, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open " + binaryPath);
+
+    char magic[sizeof(LOG_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, LOG_MAGIC, sizeof(magic)) != 0)
+        throw std::runtime_error(binaryPath + ": not a pz_5 binary log");
+
+    std::ofstream out(textPath);
+    std::string text;
+    LogRecord record;
+    size_t count = 0;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        formatLogRecord(record, text);
+        ++count;
+        if (text.size() >= 64 * 1024)
+        {
+            out << text;
+            text.clear();
+        }
+    }
+    out << text;
+    return count;
+}
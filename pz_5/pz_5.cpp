@@ -1,14 +1,16 @@
 #include <iostream>
 #include <thread>
 #include <mutex>
-#include <queue>
-#include <fstream>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include "async_logger.h"
+#include "log_record.h"
 
-std::mutex queueMutex;
-std::queue<std::string> sharedQueue;
 std::atomic<int> counter{0};
 
 std::mutex fibMutex;                    // отдельный мьютекс для Fibonacci
@@ -16,50 +18,120 @@ std::condition_variable cv;
 bool fibReady = false;
 long long resultFib = 0;
 
-// ======================= ПОТОКИ ЗАПИСИ В ОЧЕРЕДЬ ==================================
+// ======================= ПОТОКИ ЗАПИСИ В ЛОГ ==================================
 
-void writerThread(int id, long long& waitTime)
+// Поток кладёт в лог двоичную запись фиксированного размера - без to_string
+// и выделения памяти. Текст получается потом из файла (decodeLogFile).
+// waitTime - суммарное время внутри logger.append()
+void writerThread(int id, AsyncFileLogger& logger, long long& waitTime)
 {
     using namespace std::chrono;
 
     for (int i = 0; i < 5; i++)
     {
         auto start = high_resolution_clock::now();
-
-        std::unique_lock<std::mutex> lock(queueMutex);
-
+        LogRecord record = makeLogRecord(static_cast<uint32_t>(id), static_cast<uint32_t>(counter++));
+        logger.append(&record, sizeof(record));
         auto end = high_resolution_clock::now();
         waitTime += duration_cast<microseconds>(end - start).count();
 
-        std::string text = "Thread " + std::to_string(id) +
-                          " -> value " + std::to_string(counter++);
-        sharedQueue.push(text);
-
-        lock.unlock(); // освобождаем раньше для минимизации времени блокировки
-
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
-// ======================== ПОТОК ЗАПИСИ ОЧЕРЕДИ В ФАЙЛ ============================
+// ======================== НАГРУЗКА НА ЛОГГЕР ============================
 
-void saveToFile()
+struct LoggerLoadStats
 {
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    double seconds;
+    size_t bytes;
+    size_t batches;
+    long long avgNs;
+    long long p99Ns;
+    long long maxNs;
+};
+
+// threads потоков по messagesPerThread вызовов logCall(logger, thread, i).
+// Замеряется весь вызов на стороне производителя - вместе с форматированием
+template<typename LogCall>
+LoggerLoadStats runLoggerLoad(const char* path, LogCall logCall, bool binary)
+{
+    using namespace std::chrono;
 
-    std::ofstream file("output.txt");
-    std::unique_lock<std::mutex> lock(queueMutex);
+    const int threads = 4;
+    const int messagesPerThread = 200000;
 
-    while (!sharedQueue.empty())
+    // Каждый поток пишет задержки в свой заранее выделенный массив
+    std::vector<std::vector<long long>> latencies(threads, std::vector<long long>(messagesPerThread));
+
+    LoggerLoadStats stats{};
+    auto start = steady_clock::now();
     {
-        file << sharedQueue.front() << "\n";
-        sharedQueue.pop();
+        AsyncFileLogger logger(path);
+        if (binary)
+            logger.append(LOG_MAGIC, sizeof(LOG_MAGIC));
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threads; t++)
+        {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < messagesPerThread; i++)
+                {
+                    auto before = steady_clock::now();
+                    logCall(logger, t, i);
+                    latencies[t][i] = duration_cast<nanoseconds>(steady_clock::now() - before).count();
+                }
+            });
+        }
+        for (auto& w : writers)
+            w.join();
+
+        if (!logger.stop())
+            std::cerr << path << ": ошибка записи: " << std::strerror(logger.writeError()) << "\n";
+        stats.bytes = logger.bytesWritten();
+        stats.batches = logger.batchesWritten();
     }
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+
+    std::vector<long long> all;
+    all.reserve(static_cast<size_t>(threads) * messagesPerThread);
+    for (auto& l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+
+    long long total = 0;
+    for (long long ns : all)
+        total += ns;
+    std::sort(all.begin(), all.end());
+
+    stats.avgNs = total / static_cast<long long>(all.size());
+    stats.p99Ns = all[all.size() * 99 / 100];
+    stats.maxNs = all.back();
+    return stats;
+}
 
-    lock.unlock();
-    file.close();
-
-    std::cout << "Queue saved -> output.txt\n";
+// Строковый путь (to_string + конкатенация на производителе) против двоичного
+// (16-байтная запись, текст строится офлайн)
+void benchmarkLogger()
+{
+    auto printStats = [](const char* name, const LoggerLoadStats& s) {
+        std::cout << "  " << name << ": среднее " << s.avgNs << " нс, p99 " << s.p99Ns
+                  << " нс, максимум " << s.maxNs << " нс; " << s.bytes << " байт, "
+                  << s.batches << " write(), " << s.seconds * 1000 << " мс\n";
+    };
+
+    std::cout << "\nЛоггер: 4 x 200000 записей, время одного вызова на производителе\n";
+
+    LoggerLoadStats text = runLoggerLoad("output_bench.txt", [](AsyncFileLogger& logger, int t, int i) {
+        std::string line = "Thread " + std::to_string(t) + " -> value " + std::to_string(i);
+        logger.log(line);
+    }, false);
+    printStats("строка  ", text);
+
+    LoggerLoadStats binary = runLoggerLoad("output_bench.bin", [](AsyncFileLogger& logger, int t, int i) {
+        LogRecord record = makeLogRecord(static_cast<uint32_t>(t), static_cast<uint32_t>(i));
+        logger.append(&record, sizeof(record));
+    }, true);
+    printStats("двоичная", binary);
 }
 
 // ========================== FIBONACCI + condition_variable ========================
@@ -105,10 +177,12 @@ int main()
 {
     long long wait1 = 0, wait2 = 0, wait3 = 0;
 
-    std::thread t1(writerThread, 1, std::ref(wait1));
-    std::thread t2(writerThread, 2, std::ref(wait2));
-    std::thread t3(writerThread, 3, std::ref(wait3));
-    std::thread saver(saveToFile);
+    AsyncFileLogger logger("output.bin");
+    logger.append(LOG_MAGIC, sizeof(LOG_MAGIC));
+
+    std::thread t1(writerThread, 1, std::ref(logger), std::ref(wait1));
+    std::thread t2(writerThread, 2, std::ref(logger), std::ref(wait2));
+    std::thread t3(writerThread, 3, std::ref(logger), std::ref(wait3));
 
     std::thread fibProd(fibProducer);
     std::thread fibCons(fibConsumer);
@@ -116,7 +190,17 @@ int main()
     t1.join();
     t2.join();
     t3.join();
-    saver.join();
+
+    if (logger.stop())
+    {
+        size_t records = decodeLogFile("output.bin", "output.txt");
+        std::cout << "Log saved -> output.bin (" << logger.bytesWritten() << " bytes), "
+                  << records << " records decoded -> output.txt\n";
+    }
+    else
+    {
+        std::cerr << "output.bin: ошибка записи: " << std::strerror(logger.writeError()) << "\n";
+    }
 
     fibProd.join();
     fibCons.join();
@@ -126,5 +210,7 @@ int main()
     std::cout << "Thread 2: " << wait2 << " мкс\n";
     std::cout << "Thread 3: " << wait3 << " мкс\n";
 
+    benchmarkLogger();
+
     return 0;
 }
\ No newline at end of file
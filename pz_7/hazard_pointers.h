@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+#include "locks.h"
+
+// Указатели опасности (hazard pointers, Michael 2004). Перед разыменованием
+// общего указателя поток публикует его в своём слоте; удалённый из структуры
+// узел отправляется в retire-список и освобождается только тогда, когда ни
+// один слот на него не указывает. Домен один на процесс
+class HazardPointers {
+public:
+    static constexpr int MAX_THREADS = 256;
+    static constexpr int PER_THREAD = 2;
+    // Сканирование раз в столько retire - амортизирует обход всех слотов
+    static constexpr std::size_t SCAN_THRESHOLD = 2 * MAX_THREADS * PER_THREAD;
+
+    static HazardPointers& instance() {
+        static HazardPointers domain;
+        return domain;
+    }
+
+    // Публикует значение src в слоте index и перечитывает src: если значение
+    // не изменилось, узел гарантированно ещё не был отдан в retire
+    template<typename T>
+    T* protect(int index, std::atomic<T*> const& src) {
+        std::atomic<void*>& hp = thread_record().slot->hazards[index];
+        T* p = src.load(std::memory_order_relaxed);
+        for (;;) {
+            hp.store(p, std::memory_order_seq_cst);
+            T* const again = src.load(std::memory_order_acquire);
+            if (again == p) {
+                return p;
+            }
+            p = again;
+        }
+    }
+
+    void clear(int index) {
+        thread_record().slot->hazards[index].store(nullptr, std::memory_order_release);
+    }
+
+    template<typename T>
+    void retire(T* p) {
+        ThreadRecord& record = thread_record();
+        record.retired.push_back({ p, [](void* q) { delete static_cast<T*>(q); } });
+        if (record.retired.size() >= SCAN_THRESHOLD) {
+            scan(record.retired);
+        }
+    }
+
+    ~HazardPointers() {
+        // Все потоки завершены - остатки никем не защищены
+        for (auto const& r : orphans) {
+            r.deleter(r.ptr);
+        }
+    }
+
+private:
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+    };
+
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<void*> hazards[PER_THREAD] = {};
+        std::atomic<bool> active{ false };
+    };
+
+    // Слот и retire-список потока; при завершении потока слот освобождается,
+    // а ещё защищённые узлы переходят в общий список сирот
+    struct ThreadRecord {
+        Slot* slot = nullptr;
+        std::vector<Retired> retired;
+
+        ~ThreadRecord() {
+            if (slot == nullptr) {
+                return;
+            }
+            HazardPointers& domain = instance();
+            for (auto& hp : slot->hazards) {
+                hp.store(nullptr, std::memory_order_release);
+            }
+            domain.scan(retired);
+            {
+                std::lock_guard<std::mutex> guard(domain.orphans_mutex);
+                domain.orphans.insert(domain.orphans.end(), retired.begin(), retired.end());
+            }
+            slot->active.store(false, std::memory_order_release);
+        }
+    };
+
+    Slot slots[MAX_THREADS];
+    std::mutex orphans_mutex;
+    std::vector<Retired> orphans;
+
+    ThreadRecord& thread_record() {
+        thread_local ThreadRecord record;
+        if (record.slot == nullptr) {
+            for (Slot& s : slots) {
+                bool expected = false;
+                if (!s.active.load(std::memory_order_relaxed) &&
+                    s.active.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    record.slot = &s;
+                    break;
+                }
+            }
+            if (record.slot == nullptr) {
+                throw std::runtime_error("HazardPointers: more than MAX_THREADS threads");
+            }
+        }
+        return record;
+    }
+
+    // Освобождает из retired всё, на что не указывает ни один слот;
+    // заодно забирает сирот, оставленных завершившимися потоками
+    void scan(std::vector<Retired>& retired) {
+        {
+            std::lock_guard<std::mutex> guard(orphans_mutex);
+            retired.insert(retired.end(), orphans.begin(), orphans.end());
+            orphans.clear();
+        }
+
+        std::vector<void*> protected_ptrs;
+        for (Slot& s : slots) {
+            if (!s.active.load(std::memory_order_acquire)) {
+                continue;
+            }
+            for (auto& hp : s.hazards) {
+                if (void* p = hp.load(std::memory_order_seq_cst)) {
+                    protected_ptrs.push_back(p);
+                }
+            }
+        }
+        std::sort(protected_ptrs.begin(), protected_ptrs.end());
+
+        auto const keep_end = std::partition(retired.begin(), retired.end(), [&](Retired const& r) {
+            return std::binary_search(protected_ptrs.begin(), protected_ptrs.end(), r.ptr);
+        });
+        for (auto it = keep_end; it != retired.end(); ++it) {
+            it->deleter(it->ptr);
+        }
+        retired.erase(keep_end, retired.end());
+    }
+};
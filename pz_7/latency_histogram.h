@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <algorithm>
+
+// Лог-линейная гистограмма задержек (в наносекундах): каждая степень двойки
+// делится на SUB линейных корзин, так что относительная погрешность не больше
+// 1 / SUB (~6%) во всём диапазоне 0..2^64. Запись - пара сдвигов и инкремент
+// без ветвлений по данным; у каждого потока своя гистограмма, сливаются после join
+struct LatencyHistogram {
+    static constexpr int SUB_BITS = 4;
+    static constexpr uint64_t SUB = uint64_t{ 1 } << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+
+    // Значения < SUB - точные корзины; дальше группа по старшему биту
+    // и SUB_BITS следующих за ним битов
+    static int bucket_of(uint64_t v) {
+        if (v < SUB) {
+            return static_cast<int>(v);
+        }
+        int const shift = std::bit_width(v) - 1 - SUB_BITS;
+        return (shift + 1) * static_cast<int>(SUB) + static_cast<int>((v >> shift) - SUB);
+    }
+
+    // Наибольшее значение, попадающее в корзину
+    static uint64_t bucket_upper(int bucket) {
+        if (bucket < static_cast<int>(SUB)) {
+            return static_cast<uint64_t>(bucket);
+        }
+        int const shift = bucket / static_cast<int>(SUB) - 1;
+        uint64_t const mantissa = SUB + bucket % SUB;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    void record(uint64_t v) {
+        ++counts[bucket_of(v)];
+        ++total;
+        max_value = std::max(max_value, v);
+    }
+
+    void merge(LatencyHistogram const& other) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    // Верхняя граница корзины, в которую попал p-й процентиль (p в [0, 100])
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t const rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * total + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(bucket_upper(i), max_value);
+            }
+        }
+        return max_value;
+    }
+};
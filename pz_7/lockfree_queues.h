@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <queue>
+#include <vector>
+#include <cstddef>
+#include <concepts>
+
+#include "locks.h"
+#include "hazard_pointers.h"
+
+// Очередь для push/pop-нагрузки run_queue_test. try_pop возвращает false,
+// если очередь пуста; push ограниченной очереди ждёт свободного места
+template<typename Q>
+concept ConcurrentQueue = requires(Q& q, int v) {
+    q.push(v);
+    { q.try_pop(v) } -> std::same_as<bool>;
+    { q.name() } -> std::convertible_to<const char*>;
+};
+
+// std::queue<int> под замком - то, что меряет run_test
+template<Lockable L>
+struct LockedQueue {
+    L lock;
+    std::queue<int> q;
+
+    void push(int v) {
+        lock.lock();
+        q.push(v);
+        lock.unlock();
+    }
+
+    bool try_pop(int& v) {
+        lock.lock();
+        bool const ok = !q.empty();
+        if (ok) {
+            v = q.front();
+            q.pop();
+        }
+        lock.unlock();
+        return ok;
+    }
+
+    const char* name() const { return lock.name(); }
+};
+
+// Ограниченная MPMC-очередь Вьюкова. У каждой ячейки свой счётчик sequence:
+// sequence == pos - ячейка свободна для записи с номером pos,
+// sequence == pos + 1 - в ней лежит значение для чтения с номером pos.
+// Производители и потребители сталкиваются только на своём CAS позиции
+template<typename T>
+class BoundedMPMCQueue {
+public:
+    explicit BoundedMPMCQueue(std::size_t capacity_pow2 = 1 << 16)
+        : mask(capacity_pow2 - 1), cells(capacity_pow2) {
+        for (std::size_t i = 0; i < capacity_pow2; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_push(T const& value) {
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t const seq = cell.sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // полна: ячейку ещё не освободил потребитель прошлого круга
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void push(T const& value) {
+        SpinWait wait;
+        while (!try_push(value)) {
+            wait.wait();
+        }
+    }
+
+    bool try_pop(T& value) {
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t const seq = cell.sequence.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    // Освобождаем ячейку для записи на следующем круге
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // пуста
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const char* name() const { return "Vyukov MPMC ring"; }
+
+private:
+    struct alignas(CACHE_LINE) Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::size_t const mask;
+    std::vector<Cell> cells;
+    alignas(CACHE_LINE) std::atomic<std::size_t> enqueue_pos{ 0 };
+    alignas(CACHE_LINE) std::atomic<std::size_t> dequeue_pos{ 0 };
+};
+
+// Неограниченная очередь Майкла-Скотта. head указывает на фиктивный узел,
+// значение лежит в head->next. Снятый узел освобождается через указатели
+// опасности: слот 0 держит head/tail, слот 1 - следующий за head узел
+template<typename T>
+class MSQueue {
+public:
+    MSQueue() {
+        Node* const dummy = new Node{};
+        head.store(dummy, std::memory_order_relaxed);
+        tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    ~MSQueue() {
+        Node* node = head.load(std::memory_order_relaxed);
+        while (node != nullptr) {
+            Node* const next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    MSQueue(MSQueue const&) = delete;
+    MSQueue& operator=(MSQueue const&) = delete;
+
+    void push(T const& value) {
+        HazardPointers& hp = HazardPointers::instance();
+        Node* const node = new Node{ {}, value };
+        for (;;) {
+            Node* const last = hp.protect(0, tail);
+            Node* next = last->next.load(std::memory_order_acquire);
+            if (last != tail.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if (next != nullptr) {
+                // tail отстал - помогаем продвинуть
+                Node* expected = last;
+                tail.compare_exchange_weak(expected, next, std::memory_order_release);
+                continue;
+            }
+            if (last->next.compare_exchange_weak(next, node, std::memory_order_release)) {
+                Node* expected = last;
+                tail.compare_exchange_strong(expected, node, std::memory_order_release);
+                hp.clear(0);
+                return;
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        HazardPointers& hp = HazardPointers::instance();
+        for (;;) {
+            Node* const first = hp.protect(0, head);
+            Node* const last = tail.load(std::memory_order_acquire);
+            Node* const next = hp.protect(1, first->next);
+            if (first != head.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if (next == nullptr) {
+                hp.clear(0);
+                hp.clear(1);
+                return false;
+            }
+            if (first == last) {
+                Node* expected = last;
+                tail.compare_exchange_weak(expected, next, std::memory_order_release);
+                continue;
+            }
+            // Читаем до CAS: после него next может снять и освободить другой поток
+            T const result = next->value;
+            Node* expected = first;
+            if (head.compare_exchange_strong(expected, next, std::memory_order_acq_rel)) {
+                value = result;
+                hp.clear(0);
+                hp.clear(1);
+                hp.retire(first);
+                return true;
+            }
+        }
+    }
+
+    const char* name() const { return "Michael-Scott + HP"; }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{ nullptr };
+        T value{};
+    };
+
+    alignas(CACHE_LINE) std::atomic<Node*> head;
+    alignas(CACHE_LINE) std::atomic<Node*> tail;
+};
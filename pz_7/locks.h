@@ -0,0 +1,323 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <concepts>
+#include <chrono>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+constexpr std::size_t CACHE_LINE = 64;
+
+struct ILock {
+    virtual void lock() = 0;
+    virtual void unlock() = 0;
+    virtual const char* name() const = 0;
+    virtual ~ILock() = default;
+};
+
+// Всё, что умеет lock()/unlock() и назвать себя. Для ILock& вызовы идут через
+// vtable; для конкретного замка (все они final) - статически и встраиваются
+template<typename L>
+concept Lockable = requires(L& l) {
+    l.lock();
+    l.unlock();
+    { l.name() } -> std::convertible_to<const char*>;
+};
+
+// Подсказка процессору, что мы в цикле ожидания: на x86 pause снижает
+// энергопотребление и освобождает ресурсы ядра соседнему SMT-потоку
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Ожидание с экспоненциальной задержкой: 1, 2, 4 ... SPIN_LIMIT pause подряд,
+// после чего уступаем процессор. Без yield очереди FIFO (ticket, MCS, CLH)
+// при потоков больше, чем ядер, ждут, пока вытесненный владелец не получит квант
+struct SpinWait {
+    static constexpr int SPIN_LIMIT = 64;
+    int spins = 1;
+
+    void wait() {
+        if (spins <= SPIN_LIMIT) {
+            for (int i = 0; i < spins; ++i) {
+                cpu_relax();
+            }
+            spins *= 2;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+};
+
+struct StdMutexLock final : ILock {
+    std::mutex m;
+    void lock() override { m.lock(); }
+    void unlock() override { m.unlock(); }
+    const char* name() const override { return "std::mutex"; }
+};
+
+struct SpinlockFlag final : ILock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+    void lock() override {
+        // гарантирует, что все операции после этой точки "увидят" изменения, сделанные до release
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Атомарно сбрасывает флаг в false
+    // Освобождает блокировку. memory_order_release гарантирует, что все операции до этой точки будут видны другим потокам, которые сделают acquire
+    void unlock() override {
+        flag.clear(std::memory_order_release);
+    }
+
+    const char* name() const override { return "atomic_flag spinlock"; }
+};
+
+struct SpinlockBool final : ILock {
+    std::atomic<bool> locked{ false };
+
+    void lock() override {
+        bool expected = false;
+        // Если locked == expected (т.е. false) - устанавливает locked = true, возвращает true
+        // Если locked != expected → записывает в expected текущее значение locked, возвращает false
+        while (!locked.compare_exchange_weak(
+            expected, true,
+            std::memory_order_acquire)) {
+            expected = false; // Потому что при неудачном compare_exchange, expected был перезаписан на true. Возвращаем его к false для следующей попытки
+            std::this_thread::yield();
+        }
+    }
+
+    //  Атомарно записывает false в locked
+    void unlock() override {
+        locked.store(false, std::memory_order_release);
+    }
+
+    const char* name() const override { return "atomic<bool> spinlock"; }
+};
+
+// Test-and-test-and-set: ждём на обычном чтении (линия остаётся в общем
+// состоянии в кэшах ждущих), атомарный exchange - только когда замок выглядит свободным.
+// После неудачной попытки - экспоненциальная задержка на pause
+struct TTASBackoffLock final : ILock {
+    alignas(CACHE_LINE) std::atomic<bool> locked{ false };
+
+    void lock() override {
+        SpinWait backoff;
+        for (;;) {
+            while (locked.load(std::memory_order_relaxed)) {
+                backoff.wait();
+            }
+            if (!locked.exchange(true, std::memory_order_acquire)) {
+                return;
+            }
+            backoff.wait();
+        }
+    }
+
+    void unlock() override {
+        locked.store(false, std::memory_order_release);
+    }
+
+    const char* name() const override { return "TTAS + backoff"; }
+};
+
+// Билетный замок: FIFO по номеру билета. Все ждущие читают одну линию
+// now_serving, поэтому каждая передача инвалидирует её у всех ждущих
+struct TicketLock final : ILock {
+    alignas(CACHE_LINE) std::atomic<uint32_t> next_ticket{ 0 };
+    alignas(CACHE_LINE) std::atomic<uint32_t> now_serving{ 0 };
+
+    void lock() override {
+        uint32_t const ticket = next_ticket.fetch_add(1, std::memory_order_relaxed);
+        SpinWait wait;
+        while (now_serving.load(std::memory_order_acquire) != ticket) {
+            wait.wait();
+        }
+    }
+
+    void unlock() override {
+        // Писать now_serving может только владелец - хватает load + store
+        now_serving.store(now_serving.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+    }
+
+    const char* name() const override { return "ticket"; }
+};
+
+// MCS: очередь из узлов ждущих, каждый крутится на флаге в собственном узле,
+// передача замка трогает только линию следующего. Узел - thread_local,
+// поэтому поток может одновременно держать только один MCS-замок
+struct MCSLock final : ILock {
+    struct alignas(CACHE_LINE) Node {
+        std::atomic<Node*> next{ nullptr };
+        std::atomic<bool> locked{ false };
+    };
+
+    alignas(CACHE_LINE) std::atomic<Node*> tail{ nullptr };
+
+    static Node& my_node() {
+        thread_local Node node;
+        return node;
+    }
+
+    void lock() override {
+        Node& node = my_node();
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.locked.store(true, std::memory_order_relaxed);
+
+        // acq_rel: публикуем инициализацию узла и видим узел предшественника
+        Node* const prev = tail.exchange(&node, std::memory_order_acq_rel);
+        if (prev == nullptr) {
+            return;
+        }
+
+        prev->next.store(&node, std::memory_order_release);
+        SpinWait wait;
+        while (node.locked.load(std::memory_order_acquire)) {
+            wait.wait();
+        }
+    }
+
+    void unlock() override {
+        Node& node = my_node();
+        Node* next = node.next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            // Очередь пуста - пробуем вернуть tail в nullptr
+            Node* expected = &node;
+            if (tail.compare_exchange_strong(expected, nullptr,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+            // Преемник уже сделал exchange, но ещё не записал next - ждём его
+            SpinWait wait;
+            while ((next = node.next.load(std::memory_order_acquire)) == nullptr) {
+                wait.wait();
+            }
+        }
+        next->locked.store(false, std::memory_order_release);
+    }
+
+    const char* name() const override { return "MCS"; }
+};
+
+// CLH: неявная очередь - каждый поток крутится на узле предшественника.
+// При освобождении поток забирает узел предшественника себе, а свой оставляет
+// следующему, поэтому узлы мигрируют между потоками: всего их threads + 1.
+// Как и у MCS, поток держит не более одного CLH-замка одновременно
+struct CLHLock final : ILock {
+    struct alignas(CACHE_LINE) Node {
+        std::atomic<bool> locked{ false };
+    };
+
+    // Узлы текущего потока; освобождается при завершении потока
+    struct ThreadNodes {
+        Node* mine = new Node;
+        Node* pred = nullptr;
+        ~ThreadNodes() { delete mine; }
+    };
+
+    alignas(CACHE_LINE) std::atomic<Node*> tail{ new Node };
+
+    ~CLHLock() override { delete tail.load(); }
+
+    static ThreadNodes& thread_nodes() {
+        thread_local ThreadNodes nodes;
+        return nodes;
+    }
+
+    void lock() override {
+        ThreadNodes& nodes = thread_nodes();
+        nodes.mine->locked.store(true, std::memory_order_relaxed);
+        nodes.pred = tail.exchange(nodes.mine, std::memory_order_acq_rel);
+
+        SpinWait wait;
+        while (nodes.pred->locked.load(std::memory_order_acquire)) {
+            wait.wait();
+        }
+    }
+
+    void unlock() override {
+        ThreadNodes& nodes = thread_nodes();
+        Node* const released = nodes.mine;
+        // Узел предшественника больше никто не читает - он становится нашим
+        nodes.mine = nodes.pred;
+        released->locked.store(false, std::memory_order_release);
+    }
+
+    const char* name() const override { return "CLH"; }
+};
+
+// Сколько pause укладывается в SPIN_BUDGET_NS - измеряется один раз.
+// Бюджет порядка стоимости пары futex wait/wake: дольше крутиться бессмысленно
+inline int calibrated_spin_count() {
+    static int const spins = [] {
+        constexpr int SAMPLE = 20000;
+        constexpr double SPIN_BUDGET_NS = 2000.0;
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SAMPLE; ++i) {
+            cpu_relax();
+        }
+        double const pause_ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count() / SAMPLE;
+        return std::clamp(static_cast<int>(SPIN_BUDGET_NS / std::max(pause_ns, 0.1)), 16, 1 << 16);
+    }();
+    return spins;
+}
+
+// Крутимся calibrated_spin_count() итераций, затем засыпаем в atomic::wait
+// (futex на Linux). waiters считает спящих: при нуле unlock обходится без
+// системного вызова notify. Все операции над locked и waiters - seq_cst:
+// если unlock прочитал waiters == 0, то инкремент ждущего упорядочен после
+// сброса locked, и его exchange увидит свободный замок - пробуждение не теряется
+struct SpinParkLock final : ILock {
+    alignas(CACHE_LINE) std::atomic<uint32_t> locked{ 0 };
+    std::atomic<uint32_t> waiters{ 0 };
+
+    void lock() override {
+        int const spins = calibrated_spin_count();
+        for (int i = 0; i < spins; ++i) {
+            if (locked.load(std::memory_order_relaxed) == 0 &&
+                locked.exchange(1, std::memory_order_acquire) == 0) {
+                return;
+            }
+            cpu_relax();
+        }
+
+        waiters.fetch_add(1);
+        while (locked.exchange(1) != 0) {
+            locked.wait(1);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void unlock() override {
+        locked.store(0);
+        if (waiters.load() != 0) {
+            locked.notify_one();
+        }
+    }
+
+    const char* name() const override { return "spin-then-park"; }
+};
+
+// Список типов замков бенчмарка: из него строятся и объекты для ILock-прогонов,
+// и статически диспетчеризуемые инстанциации run_test
+template<typename... Locks>
+struct LockList {};
+
+using AllLocks = LockList<StdMutexLock, SpinlockFlag, SpinlockBool,
+                          TTASBackoffLock, TicketLock, MCSLock, CLHLock, SpinParkLock>;
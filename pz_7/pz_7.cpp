@@ -5,91 +5,361 @@
 #include <queue>
 #include <vector>
 #include <chrono>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <fstream>
+#include <ctime>
+
+#include "locks.h"
+#include "latency_histogram.h"
+#include "lockfree_queues.h"
+#include "read_mostly.h"
+#include "topology.h"
 
 constexpr int OPS_PER_THREAD = 500000;
 constexpr int NUM_RUNS = 5;
+constexpr int FAIRNESS_MS = 500;
+constexpr int LATENCY_MS = 200;
 
-struct ILock {
-    virtual void lock() = 0;
-    virtual void unlock() = 0;
-    virtual const char* name() const = 0;
-    virtual ~ILock() = default;
-};
+// L = ILock - вызовы через vtable, L = конкретный замок - статические
+template<Lockable L>
+double run_test(L& lock, unsigned int threads, std::atomic<bool>& start_flag) {
+    std::queue<int> q;
 
-struct StdMutexLock : ILock {
-    std::mutex m;
-    void lock() override { m.lock(); }
-    void unlock() override { m.unlock(); }
-    const char* name() const override { return "std::mutex"; }
-};
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
 
-struct SpinlockFlag : ILock {
-    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, thread_id = t] {
+            while (!start_flag.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
 
-    void lock() override {
-        // гарантирует, что все операции после этой точки "увидят" изменения, сделанные до release
-        while (flag.test_and_set(std::memory_order_acquire)) {
-            std::this_thread::yield();
-        }
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                lock.lock();
+                q.push(static_cast<int>(thread_id) * OPS_PER_THREAD + i);
+                if (!q.empty()) {
+                    q.pop();
+                }
+                lock.unlock();
+            }
+        });
     }
 
-    // Атомарно сбрасывает флаг в false
-    // Освобождает блокировку. memory_order_release гарантирует, что все операции до этой точки будут видны другим потокам, которые сделают acquire
-    void unlock() override {
-        flag.clear(std::memory_order_release);
+    auto start = std::chrono::high_resolution_clock::now();
+    // RELEASE: гарантирует, что time_point записан в память  ПЕРЕД тем, как потоки увидят флаг
+    start_flag.store(true, std::memory_order_release);
+
+    for (auto& th : workers) {
+        th.join();
     }
 
-    const char* name() const override { return "atomic_flag spinlock"; }
-};
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
 
-struct SpinlockBool : ILock {
-    std::atomic<bool> locked{ false };
-
-    void lock() override {
-        bool expected = false;
-        // Если locked == expected (т.е. false) - устанавливает locked = true, возвращает true
-        // Если locked != expected → записывает в expected текущее значение locked, возвращает false
-        while (!locked.compare_exchange_weak(
-            expected, true,
-            std::memory_order_acquire)) {
-            expected = false; // Потому что при неудачном compare_exchange, expected был перезаписан на true. Возвращаем его к false для следующей попытки
-            std::this_thread::yield();
-        }
-    }
+// Каждый прогон - дважды на одном и том же объекте: через ILock& и напрямую.
+// Разница - цена виртуального вызова и потерянного встраивания
+template<Lockable L>
+    requires std::derived_from<L, ILock>
+void benchmark_lock(L& lock, unsigned int threads) {
+    std::cout << "Testing " << lock.name() << "...\n";
 
-    //  Атомарно записывает false в locked
-    void unlock() override {
-        locked.store(false, std::memory_order_release);
+    ILock& dynamic_lock = lock;
+    double best_virtual = 0, best_static = 0;
+    for (int run = 0; run < NUM_RUNS; ++run) {
+        std::atomic<bool> virtual_flag{ false };
+        double const virtual_ms = run_test(dynamic_lock, threads, virtual_flag);
+        std::atomic<bool> static_flag{ false };
+        double const static_ms = run_test(lock, threads, static_flag);
+
+        best_virtual = run == 0 ? virtual_ms : std::min(best_virtual, virtual_ms);
+        best_static = run == 0 ? static_ms : std::min(best_static, static_ms);
+        std::cout << "  Run " << (run + 1) << ": " << std::fixed << std::setprecision(1)
+                  << virtual_ms << " ms virtual, " << static_ms << " ms static\n";
     }
+    std::cout << "  Best: " << best_virtual << " ms virtual, " << best_static << " ms static ("
+              << std::showpos << (best_static - best_virtual) / best_virtual * 100.0
+              << std::noshowpos << "%)\n\n";
+}
+
+// Каждый замок создаётся заново - прогоны не делят состояние
+template<typename L>
+void benchmark_lock_type(unsigned int threads) {
+    L lock;
+    benchmark_lock(lock, threads);
+}
+
+template<typename... Locks>
+void benchmark_locks(LockList<Locks...>, unsigned int threads) {
+    (benchmark_lock_type<Locks>(threads), ...);
+}
 
-    const char* name() const override { return "atomic<bool> spinlock"; }
+template<typename... Locks>
+std::vector<std::unique_ptr<ILock>> make_locks(LockList<Locks...>) {
+    std::vector<std::unique_ptr<ILock>> locks;
+    (locks.push_back(std::make_unique<Locks>()), ...);
+    return locks;
+}
+
+// ======================== Справедливость =============================
+
+// Каждый поток крутит тот же push/pop FAIRNESS_MS миллисекунд; возвращается
+// число операций, выполненных каждым потоком. Несправедливый замок
+// отдаётся одному и тому же потоку, остальные простаивают
+struct alignas(CACHE_LINE) PaddedCounter {
+    uint64_t ops = 0;
 };
 
-long long run_test(ILock& lock, unsigned int threads, std::atomic<bool>& start_flag) {
+// cpus - размещение потоков (см. topology.h); пустой список - решает ОС.
+// Если хоть один поток не удалось закрепить, возвращается пустой вектор:
+// такой замер нельзя приписать размещению
+std::vector<uint64_t> run_fairness_test(ILock& lock, unsigned int threads,
+                                        std::vector<int> const& cpus = {}) {
     std::queue<int> q;
+    std::atomic<bool> start_flag{ false };
+    std::atomic<bool> stop_flag{ false };
+    std::atomic<bool> pin_failed{ false };
+    std::vector<PaddedCounter> counters(threads);
 
     std::vector<std::thread> workers;
     workers.reserve(threads);
 
-    for (int t = 0; t < threads; ++t) {
+    for (unsigned int t = 0; t < threads; ++t) {
         workers.emplace_back([&, thread_id = t] {
+            if (!pin_current_thread(cpus, thread_id)) {
+                pin_failed.store(true, std::memory_order_relaxed);
+            }
             while (!start_flag.load(std::memory_order_acquire)) {
                 std::this_thread::yield();
             }
 
-            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+            uint64_t ops = 0;
+            while (!stop_flag.load(std::memory_order_relaxed)) {
                 lock.lock();
-                q.push(thread_id * OPS_PER_THREAD + i);
+                q.push(static_cast<int>(thread_id));
                 if (!q.empty()) {
                     q.pop();
                 }
                 lock.unlock();
+                ++ops;
+            }
+            counters[thread_id].ops = ops;
+        });
+    }
+
+    start_flag.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(FAIRNESS_MS));
+    stop_flag.store(true, std::memory_order_relaxed);
+
+    for (auto& th : workers) {
+        th.join();
+    }
+
+    std::vector<uint64_t> ops;
+    if (pin_failed.load(std::memory_order_relaxed)) {
+        return ops;
+    }
+    for (auto const& c : counters) {
+        ops.push_back(c.ops);
+    }
+    return ops;
+}
+
+// Индекс Джейна: (sum x)^2 / (n * sum x^2); 1.0 - все потоки получили поровну, 1/n - один поток забрал всё
+double jain_index(std::vector<uint64_t> const& ops) {
+    double sum = 0, sum_sq = 0;
+    for (uint64_t x : ops) {
+        sum += static_cast<double>(x);
+        sum_sq += static_cast<double>(x) * static_cast<double>(x);
+    }
+    return sum_sq == 0 ? 0.0 : sum * sum / (ops.size() * sum_sq);
+}
+
+void benchmark_fairness(std::vector<std::unique_ptr<ILock>> const& locks, unsigned int threads) {
+    std::cout << "==============================================\n";
+    std::cout << "   FAIRNESS (" << threads << " threads, " << FAIRNESS_MS << " ms)\n";
+    std::cout << "==============================================\n";
+    std::cout << std::left << std::setw(24) << "lock" << std::right
+              << std::setw(12) << "Mops/s" << std::setw(12) << "min ops"
+              << std::setw(12) << "max ops" << std::setw(10) << "max/min"
+              << std::setw(8) << "Jain" << "\n";
+
+    for (auto const& lock : locks) {
+        std::vector<uint64_t> const ops = run_fairness_test(*lock, threads);
+        if (ops.empty()) {
+            std::cout << std::left << std::setw(24) << lock->name() << "   no data\n";
+            continue;
+        }
+        uint64_t total = 0;
+        for (uint64_t x : ops) {
+            total += x;
+        }
+        auto const [min_it, max_it] = std::minmax_element(ops.begin(), ops.end());
+
+        std::cout << std::left << std::setw(24) << lock->name() << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << total / (FAIRNESS_MS * 1000.0)
+                  << std::setw(12) << *min_it << std::setw(12) << *max_it
+                  << std::setw(10) << (*min_it ? static_cast<double>(*max_it) / *min_it : 0.0)
+                  << std::setw(8) << jain_index(ops) << "\n";
+    }
+    std::cout << "\n";
+}
+
+// ======================== Распределение задержек =============================
+
+// Строка результата развёртки: один замок, одно число потоков, одна длина
+// критической секции. Задержка - ожидание в lock(), в наносекундах
+struct LatencyRow {
+    std::string lock;
+    unsigned int threads;
+    unsigned int cs_length;
+    uint64_t ops;
+    double mops;
+    uint64_t p50, p99, p999, max;
+};
+
+// Поток крутит lock()/unlock() LATENCY_MS миллисекунд, замеряя каждое ожидание
+// в собственную гистограмму. Внутри секции - push/pop и cs_length шагов
+// зависимой арифметики над общим состоянием
+LatencyRow run_latency_test(ILock& lock, unsigned int threads, unsigned int cs_length) {
+    std::queue<int> q;
+    uint64_t shared_work = 0;
+    std::atomic<bool> start_flag{ false };
+    std::atomic<bool> stop_flag{ false };
+    std::vector<LatencyHistogram> histograms(threads);
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, thread_id = t] {
+            LatencyHistogram local;
+            while (!start_flag.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                auto const before = std::chrono::steady_clock::now();
+                lock.lock();
+                auto const acquired = std::chrono::steady_clock::now();
+
+                q.push(static_cast<int>(thread_id));
+                q.pop();
+                for (unsigned int k = 0; k < cs_length; ++k) {
+                    shared_work = shared_work * 6364136223846793005ull + k;
+                }
+                lock.unlock();
+
+                local.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(acquired - before).count()));
+            }
+            histograms[thread_id] = local;
+        });
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    start_flag.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(LATENCY_MS));
+    stop_flag.store(true, std::memory_order_relaxed);
+
+    for (auto& th : workers) {
+        th.join();
+    }
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyHistogram merged;
+    for (auto const& h : histograms) {
+        merged.merge(h);
+    }
+
+    return LatencyRow{ lock.name(), threads, cs_length, merged.total, merged.total / seconds / 1e6,
+                       merged.percentile(50), merged.percentile(99), merged.percentile(99.9),
+                       merged.max_value };
+}
+
+void write_latency_csv(std::vector<LatencyRow> const& rows, std::string const& path) {
+    std::ofstream out(path);
+    out << "lock,threads,cs_length,ops,mops,p50_ns,p99_ns,p999_ns,max_ns\n";
+    for (auto const& r : rows) {
+        out << '"' << r.lock << '"' << ',' << r.threads << ',' << r.cs_length << ',' << r.ops << ','
+            << r.mops << ',' << r.p50 << ',' << r.p99 << ',' << r.p999 << ',' << r.max << "\n";
+    }
+}
+
+void write_latency_json(std::vector<LatencyRow> const& rows, std::string const& path) {
+    std::ofstream out(path);
+    out << "[\n";
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        auto const& r = rows[i];
+        out << "  {\"lock\": \"" << r.lock << "\", \"threads\": " << r.threads
+            << ", \"cs_length\": " << r.cs_length << ", \"ops\": " << r.ops
+            << ", \"mops\": " << r.mops << ", \"p50_ns\": " << r.p50
+            << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999
+            << ", \"max_ns\": " << r.max << "}" << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// Развёртка по потокам 1, 2, 4 ... 2 * cores и длинам критической секции
+std::vector<LatencyRow> benchmark_latency(std::vector<std::unique_ptr<ILock>> const& locks,
+                                          unsigned int cores) {
+    std::cout << "==============================================\n";
+    std::cout << "   ACQUIRE LATENCY (" << LATENCY_MS << " ms per point)\n";
+    std::cout << "==============================================\n";
+    std::cout << std::left << std::setw(24) << "lock" << std::right
+              << std::setw(8) << "threads" << std::setw(6) << "cs"
+              << std::setw(10) << "Mops/s" << std::setw(10) << "p50 ns"
+              << std::setw(10) << "p99 ns" << std::setw(10) << "p99.9 ns"
+              << std::setw(12) << "max ns" << "\n";
+
+    std::vector<LatencyRow> rows;
+    for (unsigned int cs_length : { 0u, 100u, 1000u }) {
+        for (unsigned int threads = 1; threads <= 2 * cores; threads *= 2) {
+            for (auto const& lock : locks) {
+                LatencyRow const r = run_latency_test(*lock, threads, cs_length);
+                std::cout << std::left << std::setw(24) << r.lock << std::right
+                          << std::setw(8) << r.threads << std::setw(6) << r.cs_length
+                          << std::fixed << std::setprecision(2) << std::setw(10) << r.mops
+                          << std::setw(10) << r.p50 << std::setw(10) << r.p99
+                          << std::setw(10) << r.p999 << std::setw(12) << r.max << "\n";
+                rows.push_back(r);
+            }
+        }
+    }
+    std::cout << "\n";
+    return rows;
+}
+
+// ======================== Очереди без замков =============================
+
+// Та же нагрузка, что в run_test: каждый поток OPS_PER_THREAD раз кладёт
+// элемент и пытается снять один
+template<ConcurrentQueue Q>
+double run_queue_test(Q& queue, unsigned int threads) {
+    std::atomic<bool> start_flag{ false };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, thread_id = t] {
+            while (!start_flag.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            int value = 0;
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                queue.push(static_cast<int>(thread_id) * OPS_PER_THREAD + i);
+                queue.try_pop(value);
             }
         });
     }
 
     auto start = std::chrono::high_resolution_clock::now();
-    // RELEASE: гарантирует, что time_point записан в память  ПЕРЕД тем, как потоки увидят флаг
     start_flag.store(true, std::memory_order_release);
 
     for (auto& th : workers) {
@@ -97,23 +367,302 @@ long long run_test(ILock& lock, unsigned int threads, std::atomic<bool>& start_f
     }
 
     auto end = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
-void benchmark_lock(ILock& lock, int unsigned threads) {
-    std::cout << "Testing " << lock.name() << "...\n";
-
+// Лучший из NUM_RUNS прогонов, каждый на свежей очереди
+template<ConcurrentQueue Q>
+double best_queue_time(unsigned int threads) {
+    double best = 0;
     for (int run = 0; run < NUM_RUNS; ++run) {
-        std::atomic<bool> start_flag{ false };
-        auto time = run_test(lock, threads, start_flag);
-        std::cout << "  Run " << (run + 1) << ": " << time << " ms\n";
+        auto queue = std::make_unique<Q>();
+        double const ms = run_queue_test(*queue, threads);
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+template<ConcurrentQueue... Queues>
+void benchmark_queues(unsigned int cores) {
+    std::cout << "==============================================\n";
+    std::cout << "   LOCKED vs LOCK-FREE QUEUES (best of " << NUM_RUNS << ", ms)\n";
+    std::cout << "==============================================\n";
+
+    std::cout << std::setw(8) << "threads";
+    ((std::cout << std::setw(24) << Queues().name()), ...);
+    std::cout << "\n";
+
+    for (unsigned int threads = 1; threads <= 2 * cores; threads *= 2) {
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(1);
+        ((std::cout << std::setw(24) << best_queue_time<Queues>(threads)), ...);
+        std::cout << "\n";
     }
     std::cout << "\n";
 }
 
-int main() {
-    unsigned int threads = std::thread::hardware_concurrency();
-    if (threads == 0) threads = 4;
+// ======================== Читатели и писатели =============================
+
+struct RwRow {
+    std::string name;
+    unsigned int threads;
+    int read_percent;
+    double reader_mops;
+    uint64_t writes;
+    uint64_t write_p50, write_p99, write_max;
+    uint64_t torn;      // рваные снимки - должно быть 0
+};
+
+// Каждый поток LATENCY_MS миллисекунд выбирает операцию: с вероятностью
+// read_percent% - чтение, иначе запись. Чтения считаются, длительность
+// каждой записи идёт в гистограмму потока
+template<ReadMostly S>
+RwRow run_rw_test(unsigned int threads, int read_percent) {
+    S shared;
+    std::atomic<bool> start_flag{ false };
+    std::atomic<bool> stop_flag{ false };
+
+    struct alignas(CACHE_LINE) ThreadResult {
+        uint64_t reads = 0;
+        uint64_t torn = 0;
+        LatencyHistogram writes;
+    };
+    std::vector<ThreadResult> results(threads);
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, thread_id = t] {
+            ThreadResult local;
+            uint64_t rng = 0x9E3779B97F4A7C15ull * (thread_id + 1);
+            while (!start_flag.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            while (!stop_flag.load(std::memory_order_relaxed)) {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                if (static_cast<int>(rng % 100) < read_percent) {
+                    uint64_t value;
+                    if (!shared.read(value)) {
+                        ++local.torn;
+                    }
+                    ++local.reads;
+                } else {
+                    auto const before = std::chrono::steady_clock::now();
+                    shared.write(rng);
+                    local.writes.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - before).count()));
+                }
+            }
+            results[thread_id] = local;
+        });
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    start_flag.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(LATENCY_MS));
+    stop_flag.store(true, std::memory_order_relaxed);
+
+    for (auto& th : workers) {
+        th.join();
+    }
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t reads = 0, torn = 0;
+    LatencyHistogram writes;
+    for (auto const& r : results) {
+        reads += r.reads;
+        torn += r.torn;
+        writes.merge(r.writes);
+    }
+
+    return RwRow{ shared.name(), threads, read_percent, reads / seconds / 1e6, writes.total,
+                  writes.percentile(50), writes.percentile(99), writes.max_value, torn };
+}
+
+template<ReadMostly... Structures>
+void benchmark_read_mostly(unsigned int cores) {
+    std::cout << "==============================================\n";
+    std::cout << "   READ-MOSTLY SHARED DATA (" << LATENCY_MS << " ms per point)\n";
+    std::cout << "==============================================\n";
+    std::cout << std::left << std::setw(22) << "structure" << std::right
+              << std::setw(8) << "reads%" << std::setw(8) << "threads"
+              << std::setw(14) << "read Mops/s" << std::setw(12) << "writes"
+              << std::setw(12) << "wr p50 ns" << std::setw(12) << "wr p99 ns"
+              << std::setw(12) << "wr max ns" << std::setw(6) << "torn" << "\n";
+
+    auto print = [](RwRow const& r) {
+        std::cout << std::left << std::setw(22) << r.name << std::right
+                  << std::setw(8) << r.read_percent << std::setw(8) << r.threads
+                  << std::fixed << std::setprecision(2) << std::setw(14) << r.reader_mops
+                  << std::setw(12) << r.writes << std::setw(12) << r.write_p50
+                  << std::setw(12) << r.write_p99 << std::setw(12) << r.write_max
+                  << std::setw(6) << r.torn << "\n";
+    };
+
+    for (int read_percent : { 99, 90, 50 }) {
+        for (unsigned int threads = 1; threads <= 2 * cores; threads *= 2) {
+            (print(run_rw_test<Structures>(threads, read_percent)), ...);
+        }
+    }
+    std::cout << "\n";
+}
+
+// ======================== Переподписка =============================
+
+// Пропускная способность и потраченное процессорное время при числе потоков
+// 0.5x, 1x, 2x, 4x от числа ядер. Спин-замки без засыпания жгут кванты,
+// пока владелец вытеснен; "CPU busy" - среднее число занятых ядер за прогон
+void benchmark_oversubscription(std::vector<std::unique_ptr<ILock>> const& locks, unsigned int cores) {
+    std::cout << "==============================================\n";
+    std::cout << "   OVERSUBSCRIPTION (" << cores << " cores, " << FAIRNESS_MS << " ms per point)\n";
+    std::cout << "==============================================\n";
+    std::cout << std::left << std::setw(24) << "lock" << std::right
+              << std::setw(8) << "load" << std::setw(9) << "threads"
+              << std::setw(10) << "Mops/s" << std::setw(10) << "CPU busy"
+              << std::setw(12) << "Mops/CPU-s" << std::setw(8) << "Jain" << "\n";
+
+    for (double factor : { 0.5, 1.0, 2.0, 4.0 }) {
+        unsigned int const threads = std::max(1u, static_cast<unsigned int>(cores * factor));
+        for (auto const& lock : locks) {
+            std::clock_t const cpu_start = std::clock();
+            auto const wall_start = std::chrono::steady_clock::now();
+            std::vector<uint64_t> const ops = run_fairness_test(*lock, threads);
+            double const wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+            double const cpu_s = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+            uint64_t total = 0;
+            for (uint64_t x : ops) {
+                total += x;
+            }
+            std::cout << std::left << std::setw(24) << lock->name() << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(7) << factor << "x"
+                      << std::setw(9) << threads << std::setprecision(2)
+                      << std::setw(10) << total / (FAIRNESS_MS * 1000.0)
+                      << std::setw(10) << cpu_s / wall_s
+                      << std::setw(12) << (cpu_s > 0 ? total / cpu_s / 1e6 : 0.0)
+                      << std::setw(8) << jain_index(ops) << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// ======================== Размещение потоков =============================
+
+// Та же нагрузка, что в FAIRNESS, для каждой политики размещения. Число
+// потоков - не больше числа CPU в политике, чтобы не смешивать расстояние
+// передачи замка с переподпиской
+void benchmark_affinity(std::vector<std::unique_ptr<ILock>> const& locks, unsigned int max_threads) {
+    std::vector<CpuInfo> const topology = read_topology();
+    std::set<std::pair<int, int>> cores;
+    std::set<int> packages, nodes;
+    for (auto const& c : topology) {
+        cores.insert({ c.package, c.core });
+        packages.insert(c.package);
+        nodes.insert(c.node);
+    }
+
+    std::cout << "==============================================\n";
+    std::cout << "   THREAD PLACEMENT (" << FAIRNESS_MS << " ms per point)\n";
+    std::cout << "==============================================\n";
+    std::cout << "CPUs: " << topology.size() << ", cores: " << cores.size()
+              << ", packages: " << packages.size() << ", NUMA nodes: " << nodes.size() << "\n";
+    std::cout << std::left << std::setw(14) << "placement" << std::setw(24) << "lock" << std::right
+              << std::setw(9) << "threads" << std::setw(10) << "Mops/s"
+              << std::setw(10) << "max/min" << std::setw(8) << "Jain" << "   cpus\n";
+
+    for (Placement const& placement : placement_policies(topology)) {
+        unsigned int const threads = placement.cpus.empty()
+            ? max_threads
+            : std::min<unsigned int>(max_threads, static_cast<unsigned int>(placement.cpus.size()));
+
+        std::string cpu_list;
+        for (unsigned int i = 0; i < threads && i < placement.cpus.size(); ++i) {
+            cpu_list += (i ? "," : "") + std::to_string(placement.cpus[i]);
+        }
+
+        for (auto const& lock : locks) {
+            std::vector<uint64_t> const ops = run_fairness_test(*lock, threads, placement.cpus);
+            if (ops.empty()) {
+                std::cout << std::left << std::setw(14) << placement.label << std::setw(24) << lock->name()
+                          << std::right << std::setw(9) << threads
+                          << "   pin failed: " << cpu_list << "\n";
+                continue;
+            }
+            uint64_t total = 0;
+            for (uint64_t x : ops) {
+                total += x;
+            }
+            auto const [min_it, max_it] = std::minmax_element(ops.begin(), ops.end());
+
+            std::cout << std::left << std::setw(14) << placement.label << std::setw(24) << lock->name()
+                      << std::right << std::setw(9) << threads
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(10) << total / (FAIRNESS_MS * 1000.0)
+                      << std::setw(10) << (*min_it ? static_cast<double>(*max_it) / *min_it : 0.0)
+                      << std::setw(8) << jain_index(ops)
+                      << "   " << (cpu_list.empty() ? "any" : cpu_list) << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+struct Options {
+    unsigned int threads = 0;
+    bool latency = false;
+    bool queues = false;
+    bool read_mostly = false;
+    bool oversubscription = false;
+    bool affinity = false;
+    std::string csv_path;
+    std::string json_path;
+};
+
+void print_usage(char const* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--threads N] [--latency [--csv FILE] [--json FILE]] [--queues] [--rw] [--oversub] [--affinity]\n"
+              << "  --threads N   threads for the throughput and fairness runs\n"
+              << "  --latency     sweep threads and critical-section length, report acquire latency\n"
+              << "  --csv FILE    write the latency sweep as CSV\n"
+              << "  --json FILE   write the latency sweep as JSON\n"
+              << "  --queues      compare lock-guarded std::queue with lock-free queues\n"
+              << "  --rw          shared_mutex vs seqlock vs RCU snapshot at 99/1, 90/10, 50/50\n"
+              << "  --oversub     throughput and CPU burn at 0.5x, 1x, 2x, 4x threads per core\n"
+              << "  --affinity    pin threads: compact, scatter, SMT siblings, one per core, per NUMA node\n";
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 4;
+
+    // --threads: например, 8..64 для выбора замка горячих очередей
+    Options options;
+    options.threads = cores;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<unsigned int>(std::max(1, std::stoi(argv[++i])));
+        } else if (arg == "--latency") {
+            options.latency = true;
+        } else if (arg == "--queues") {
+            options.queues = true;
+        } else if (arg == "--rw") {
+            options.read_mostly = true;
+        } else if (arg == "--oversub") {
+            options.oversubscription = true;
+        } else if (arg == "--affinity") {
+            options.affinity = true;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csv_path = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    unsigned int const threads = options.threads;
 
     std::cout << "==============================================\n";
     std::cout << "   SYNCHRONIZATION MECHANISMS BENCHMARK\n";
@@ -122,13 +671,43 @@ int main() {
     std::cout << "Ops per thread:  " << OPS_PER_THREAD << "\n";
     std::cout << "Test runs:       " << NUM_RUNS << "\n\n";
 
-    StdMutexLock mutex_lock;
-    SpinlockFlag flag_lock;
-    SpinlockBool bool_lock;
+    std::vector<std::unique_ptr<ILock>> locks = make_locks(AllLocks{});
+
+    if (options.latency) {
+        std::vector<LatencyRow> const rows = benchmark_latency(locks, cores);
+        if (!options.csv_path.empty()) {
+            write_latency_csv(rows, options.csv_path);
+        }
+        if (!options.json_path.empty()) {
+            write_latency_json(rows, options.json_path);
+        }
+        return 0;
+    }
+
+    if (options.queues) {
+        benchmark_queues<LockedQueue<StdMutexLock>, LockedQueue<SpinlockFlag>, LockedQueue<SpinlockBool>,
+                         BoundedMPMCQueue<int>, MSQueue<int>>(cores);
+        return 0;
+    }
+
+    if (options.read_mostly) {
+        benchmark_read_mostly<SharedMutexTable, SeqLockTable, RcuTable>(cores);
+        return 0;
+    }
+
+    if (options.oversubscription) {
+        benchmark_oversubscription(locks, cores);
+        return 0;
+    }
+
+    if (options.affinity) {
+        benchmark_affinity(locks, threads);
+        return 0;
+    }
+
+    benchmark_locks(AllLocks{}, threads);
 
-    benchmark_lock(mutex_lock, threads);
-    benchmark_lock(flag_lock, threads);
-    benchmark_lock(bool_lock, threads);
+    benchmark_fairness(locks, threads);
 
     return 0;
 }
\ No newline at end of file
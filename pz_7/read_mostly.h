@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <array>
+#include <cstdint>
+#include <concepts>
+
+#include "locks.h"
+#include "hazard_pointers.h"
+
+// Разделяемая таблица "для чтения": писатель целиком заменяет её содержимое,
+// читатель должен увидеть согласованный снимок - все поля равны
+constexpr int TABLE_FIELDS = 8;
+
+struct Table {
+    std::array<uint64_t, TABLE_FIELDS> fields{};
+};
+
+// read() возвращает значение снимка или false, если снимок рваный
+template<typename S>
+concept ReadMostly = requires(S& s, uint64_t v) {
+    { s.read(v) } -> std::same_as<bool>;
+    s.write(v);
+    { s.name() } -> std::convertible_to<const char*>;
+};
+
+inline bool consistent(uint64_t const* fields, uint64_t& value) {
+    value = fields[0];
+    for (int i = 1; i < TABLE_FIELDS; ++i) {
+        if (fields[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Читатели берут разделяемую блокировку, писатель - исключительную.
+// Даже чтение пишет в счётчик читателей - линия мьютекса скачет между ядрами
+struct SharedMutexTable {
+    std::shared_mutex m;
+    Table table;
+
+    bool read(uint64_t& value) {
+        std::shared_lock<std::shared_mutex> guard(m);
+        return consistent(table.fields.data(), value);
+    }
+
+    void write(uint64_t value) {
+        std::unique_lock<std::shared_mutex> guard(m);
+        table.fields.fill(value);
+    }
+
+    const char* name() const { return "std::shared_mutex"; }
+};
+
+// Seqlock: писатель делает счётчик нечётным на время записи, читатель ничего
+// не пишет и повторяет чтение, если счётчик был нечётным или сменился.
+// Поля атомарные с relaxed-доступом - иначе конкурентное чтение было бы гонкой
+struct SeqLockTable {
+    alignas(CACHE_LINE) std::atomic<uint64_t> sequence{ 0 };
+    std::array<std::atomic<uint64_t>, TABLE_FIELDS> fields{};
+    alignas(CACHE_LINE) TTASBackoffLock writer_lock;    // писатели сериализуются между собой
+
+    bool read(uint64_t& value) {
+        uint64_t snapshot[TABLE_FIELDS];
+        SpinWait wait;
+        for (;;) {
+            uint64_t const before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                wait.wait();
+                continue;
+            }
+            for (int i = 0; i < TABLE_FIELDS; ++i) {
+                snapshot[i] = fields[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return consistent(snapshot, value);
+            }
+        }
+    }
+
+    void write(uint64_t value) {
+        writer_lock.lock();
+        uint64_t const seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (auto& f : fields) {
+            f.store(value, std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+        writer_lock.unlock();
+    }
+
+    const char* name() const { return "seqlock"; }
+};
+
+// RCU-подобный снимок: читатель защищает текущий указатель hazard-слотом
+// и читает неизменяемую копию; писатель публикует новую копию одним exchange
+// и откладывает удаление старой, пока её кто-то читает
+struct RcuTable {
+    alignas(CACHE_LINE) std::atomic<Table*> current{ new Table };
+
+    ~RcuTable() { delete current.load(); }
+
+    bool read(uint64_t& value) {
+        HazardPointers& hp = HazardPointers::instance();
+        Table const* const snapshot = hp.protect(0, current);
+        bool const ok = consistent(snapshot->fields.data(), value);
+        hp.clear(0);
+        return ok;
+    }
+
+    void write(uint64_t value) {
+        Table* const next = new Table;
+        next->fields.fill(value);
+        Table* const previous = current.exchange(next, std::memory_order_acq_rel);
+        HazardPointers::instance().retire(previous);
+    }
+
+    const char* name() const { return "RCU snapshot + HP"; }
+};
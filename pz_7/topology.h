@@ -0,0 +1,201 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Топология процессора из /sys/devices/system/cpu: для каждого логического
+// CPU - сокет, физическое ядро, NUMA-узел и номер SMT-потока внутри ядра.
+// Если каких-то файлов нет (контейнер, не Linux), подставляются значения
+// "каждый CPU - отдельное ядро в сокете 0, узел 0"
+struct CpuInfo {
+    int cpu;
+    int package;
+    int core;
+    int node;
+    int smt_index;      // 0 - первый поток ядра, 1 - его SMT-сосед ...
+};
+
+// Формат "0-3,8,10-11"
+inline std::vector<int> parse_cpu_list(std::string const& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        auto const dash = range.find('-');
+        int const first = std::stoi(range.substr(0, dash));
+        int const last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int c = first; c <= last; ++c) {
+            cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+inline int read_int_file(std::string const& path, int fallback) {
+    std::ifstream in(path);
+    int value;
+    return in >> value ? value : fallback;
+}
+
+inline std::vector<CpuInfo> read_topology() {
+    namespace fs = std::filesystem;
+    std::string const root = "/sys/devices/system/cpu/";
+
+    // Только CPU, на которых процессу разрешено работать
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool const have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::vector<int> online;
+    {
+        std::ifstream in(root + "online");
+        std::string text;
+        if (std::getline(in, text)) {
+            online = parse_cpu_list(text);
+        }
+    }
+    if (online.empty()) {
+        unsigned int const n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int c = 0; c < n; ++c) {
+            online.push_back(static_cast<int>(c));
+        }
+    }
+
+    std::vector<CpuInfo> cpus;
+    for (int cpu : online) {
+        if (have_mask && !CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        std::string const dir = root + "cpu" + std::to_string(cpu) + "/";
+        CpuInfo info{ cpu, read_int_file(dir + "topology/physical_package_id", 0),
+                      read_int_file(dir + "topology/core_id", cpu), 0, 0 };
+
+        std::error_code ec;
+        for (auto const& entry : fs::directory_iterator(dir, ec)) {
+            std::string const name = entry.path().filename().string();
+            if (name.rfind("node", 0) == 0 && name.size() > 4) {
+                info.node = std::stoi(name.substr(4));
+            }
+        }
+        cpus.push_back(info);
+    }
+
+    // Номер SMT-потока - порядок CPU внутри одного (сокет, ядро)
+    std::map<std::pair<int, int>, int> seen;
+    for (auto& c : cpus) {
+        c.smt_index = seen[{ c.package, c.core }]++;
+    }
+    return cpus;
+}
+
+// Политика размещения: метка для строки результата и упорядоченный список
+// CPU; поток i закрепляется за cpus[i % cpus.size()]. Пустой список - решает ОС
+struct Placement {
+    std::string label;
+    std::vector<int> cpus;
+};
+
+inline std::vector<Placement> placement_policies(std::vector<CpuInfo> const& topology) {
+    std::vector<Placement> policies;
+    policies.push_back({ "os", {} });
+
+    // compact: SMT-соседи одного ядра, затем следующее ядро того же сокета
+    std::vector<CpuInfo> sorted = topology;
+    std::sort(sorted.begin(), sorted.end(), [](CpuInfo const& a, CpuInfo const& b) {
+        return std::tie(a.package, a.core, a.smt_index) < std::tie(b.package, b.core, b.smt_index);
+    });
+    Placement compact{ "compact", {} };
+    for (auto const& c : sorted) {
+        compact.cpus.push_back(c.cpu);
+    }
+    policies.push_back(compact);
+
+    // scatter: по очереди из каждого сокета по ядру; SMT-соседи - в последнюю очередь
+    std::vector<CpuInfo> scattered = topology;
+    std::map<int, int> core_rank;      // порядковый номер ядра внутри сокета
+    {
+        std::map<int, std::set<int>> cores_of_package;
+        for (auto const& c : topology) {
+            cores_of_package[c.package].insert(c.core);
+        }
+        for (auto& c : scattered) {
+            auto const& cores = cores_of_package[c.package];
+            core_rank[c.cpu] = static_cast<int>(std::distance(cores.begin(), cores.find(c.core)));
+        }
+    }
+    std::sort(scattered.begin(), scattered.end(), [&](CpuInfo const& a, CpuInfo const& b) {
+        return std::tuple(a.smt_index, core_rank[a.cpu], a.package) <
+               std::tuple(b.smt_index, core_rank[b.cpu], b.package);
+    });
+    Placement scatter{ "scatter", {} };
+    for (auto const& c : scattered) {
+        scatter.cpus.push_back(c.cpu);
+    }
+    policies.push_back(scatter);
+
+    // smt-siblings: только потоки первого ядра, у которого их больше одного
+    Placement smt{ "smt-siblings", {} };
+    for (auto const& c : sorted) {
+        if (c.smt_index == 1) {
+            for (auto const& s : sorted) {
+                if (s.package == c.package && s.core == c.core) {
+                    smt.cpus.push_back(s.cpu);
+                }
+            }
+            break;
+        }
+    }
+    if (!smt.cpus.empty()) {
+        policies.push_back(smt);
+    }
+
+    // one-per-core: первый SMT-поток каждого ядра
+    Placement per_core{ "one-per-core", {} };
+    for (auto const& c : sorted) {
+        if (c.smt_index == 0) {
+            per_core.cpus.push_back(c.cpu);
+        }
+    }
+    policies.push_back(per_core);
+
+    // numaN: все потоки внутри одного узла, плотно
+    std::set<int> nodes;
+    for (auto const& c : topology) {
+        nodes.insert(c.node);
+    }
+    for (int node : nodes) {
+        Placement numa{ "numa" + std::to_string(node), {} };
+        for (auto const& c : sorted) {
+            if (c.node == node) {
+                numa.cpus.push_back(c.cpu);
+            }
+        }
+        policies.push_back(numa);
+    }
+    return policies;
+}
+
+// Закрепляет текущий поток за cpus[index % size]; ничего не делает для пустого списка
+inline bool pin_current_thread(std::vector<int> const& cpus, unsigned int index) {
+    if (cpus.empty()) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[index % cpus.size()], &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
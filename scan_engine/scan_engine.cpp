@@ -0,0 +1,441 @@
+#include "scan_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Размер буфера чтения: небольшой, чтобы буфер оставался в L2, пока его обходят все ядра
+constexpr size_t SCAN_BUFFER_SIZE = 256 * 1024;
+
+// ======================== Целевые байты (CR/LF/пробел) ========================
+
+CountResult merge_results(const CountResult& a, const CountResult& b) {
+    if (a.bytes_scanned == 0) return b;
+    if (b.bytes_scanned == 0) return a;
+
+    CountResult result = {
+        a.count_0a + b.count_0a,
+        a.count_0d + b.count_0d,
+        a.count_20 + b.count_20,
+        a.count_group + b.count_group,
+        std::max(a.queue_size, b.queue_size)
+    };
+    if (a.last_is_0d && b.first_is_0a) {
+        result.count_group++;
+    }
+
+    result.bytes_scanned = a.bytes_scanned + b.bytes_scanned;
+    result.first_is_0a = a.first_is_0a;
+    result.last_is_0d = b.last_is_0d;
+    return result;
+}
+
+// ======================== Векторный классификатор байтов ========================
+
+// Скалярный вариант: используется как запасной и для хвоста короче 64 байт
+ByteMasks classify_scalar(const unsigned char* p, size_t len) {
+    ByteMasks m = {0, 0, 0};
+    for (size_t i = 0; i < len; ++i) {
+        m.lf |= static_cast<uint64_t>(p[i] == TARGET_BYTE1) << i;
+        m.cr |= static_cast<uint64_t>(p[i] == TARGET_BYTE2) << i;
+        m.sp |= static_cast<uint64_t>(p[i] == TARGET_BYTE3) << i;
+    }
+    return m;
+}
+
+ByteMasks classify_block_scalar(const unsigned char* p) {
+    return classify_scalar(p, CLASSIFY_BLOCK);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2")))
+ByteMasks classify_block_sse2(const unsigned char* p) {
+    const __m128i lf = _mm_set1_epi8(static_cast<char>(TARGET_BYTE1));
+    const __m128i cr = _mm_set1_epi8(static_cast<char>(TARGET_BYTE2));
+    const __m128i sp = _mm_set1_epi8(static_cast<char>(TARGET_BYTE3));
+
+    ByteMasks m = {0, 0, 0};
+    for (int k = 0; k < 4; ++k) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        m.lf |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf)))) << (16 * k);
+        m.cr |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)))) << (16 * k);
+        m.sp |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, sp)))) << (16 * k);
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+inline uint64_t match_mask_avx2(__m256i lo, __m256i hi, __m256i target) {
+    uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, target)));
+    uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, target)));
+    return low | (high << 32);
+}
+
+__attribute__((target("avx2")))
+ByteMasks classify_block_avx2(const unsigned char* p) {
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+
+    return {
+        match_mask_avx2(lo, hi, _mm256_set1_epi8(static_cast<char>(TARGET_BYTE1))),
+        match_mask_avx2(lo, hi, _mm256_set1_epi8(static_cast<char>(TARGET_BYTE2))),
+        match_mask_avx2(lo, hi, _mm256_set1_epi8(static_cast<char>(TARGET_BYTE3)))
+    };
+}
+
+__attribute__((target("avx512f,avx512bw")))
+ByteMasks classify_block_avx512(const unsigned char* p) {
+    __m512i v = _mm512_loadu_si512(p);
+    return {
+        _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(static_cast<char>(TARGET_BYTE1))),
+        _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(static_cast<char>(TARGET_BYTE2))),
+        _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(static_cast<char>(TARGET_BYTE3)))
+    };
+}
+
+#endif
+
+// Выбор реализации во время выполнения по возможностям процессора
+Classifier select_classifier() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return {classify_block_avx512, "AVX-512"};
+    if (__builtin_cpu_supports("avx2")) return {classify_block_avx2, "AVX2"};
+    if (__builtin_cpu_supports("sse2")) return {classify_block_sse2, "SSE2"};
+#endif
+    return {classify_block_scalar, "scalar"};
+}
+
+const Classifier CLASSIFIER = select_classifier();
+
+std::vector<Classifier> available_classifiers() {
+    std::vector<Classifier> result = {{classify_block_scalar, "scalar"}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) result.push_back({classify_block_sse2, "SSE2"});
+    if (__builtin_cpu_supports("avx2")) result.push_back({classify_block_avx2, "AVX2"});
+    if (__builtin_cpu_supports("avx512bw")) result.push_back({classify_block_avx512, "AVX-512"});
+#endif
+    return result;
+}
+
+// ======================== Ядра гистограммы ========================
+
+// Эталон: одна таблица, как в исходном countFilePart
+void histogramScalar(const unsigned char* data, size_t len, uint64_t* counts) {
+    for (size_t i = 0; i < len; ++i) {
+        ++counts[data[i]];
+    }
+}
+
+// Несколько таблиц: соседние байты попадают в разные счётчики, поэтому
+// на повторяющихся данных нет цепочки store->load по одному и тому же адресу
+constexpr size_t HIST_TABLES = 8;
+constexpr size_t HIST_FLUSH_BYTES = 1u << 30;  // 32-битные счётчики сбрасываются заранее до переполнения
+
+using SubTables = std::array<std::array<uint32_t, SYMBOLS>, HIST_TABLES>;
+
+void mergeSubTables(SubTables& tables, uint64_t* counts) {
+    for (size_t s = 0; s < SYMBOLS; ++s) {
+        uint64_t sum = 0;
+        for (size_t t = 0; t < HIST_TABLES; ++t) {
+            sum += tables[t][s];
+            tables[t][s] = 0;
+        }
+        counts[s] += sum;
+    }
+}
+
+// 8 байт слова раскладываются по 8 таблицам
+inline void countWord(SubTables& tables, uint64_t word) {
+    ++tables[0][word & 0xFF];
+    ++tables[1][(word >> 8) & 0xFF];
+    ++tables[2][(word >> 16) & 0xFF];
+    ++tables[3][(word >> 24) & 0xFF];
+    ++tables[4][(word >> 32) & 0xFF];
+    ++tables[5][(word >> 40) & 0xFF];
+    ++tables[6][(word >> 48) & 0xFF];
+    ++tables[7][word >> 56];
+}
+
+void histogramMultiTable(const unsigned char* data, size_t len, uint64_t* counts) {
+    SubTables tables{};
+
+    while (len > 0) {
+        size_t part = std::min(len, HIST_FLUSH_BYTES);
+        size_t i = 0;
+
+        // Развёрнутый цикл: два 8-байтовых слова за итерацию
+        for (; i + 16 <= part; i += 16) {
+            uint64_t w0, w1;
+            std::memcpy(&w0, data + i, 8);
+            std::memcpy(&w1, data + i + 8, 8);
+            countWord(tables, w0);
+            countWord(tables, w1);
+        }
+        for (; i < part; ++i) {
+            ++tables[i % HIST_TABLES][data[i]];
+        }
+
+        mergeSubTables(tables, counts);
+        data += part;
+        len -= part;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// AVX2: 32 байта загружаются одной инструкцией и раскладываются на четыре 64-битных слова
+__attribute__((target("avx2")))
+void histogramAvx2(const unsigned char* data, size_t len, uint64_t* counts) {
+    SubTables tables{};
+
+    while (len > 0) {
+        size_t part = std::min(len, HIST_FLUSH_BYTES);
+        size_t i = 0;
+
+        for (; i + 32 <= part; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            countWord(tables, static_cast<uint64_t>(_mm256_extract_epi64(v, 0)));
+            countWord(tables, static_cast<uint64_t>(_mm256_extract_epi64(v, 1)));
+            countWord(tables, static_cast<uint64_t>(_mm256_extract_epi64(v, 2)));
+            countWord(tables, static_cast<uint64_t>(_mm256_extract_epi64(v, 3)));
+        }
+        for (; i < part; ++i) {
+            ++tables[i % HIST_TABLES][data[i]];
+        }
+
+        mergeSubTables(tables, counts);
+        data += part;
+        len -= part;
+    }
+}
+
+#endif
+
+// Выбор ядра во время выполнения
+HistogramKernel selectHistogramKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {histogramAvx2, "AVX2 + 8 таблиц"};
+#endif
+    return {histogramMultiTable, "8 таблиц, развёрнутый"};
+}
+
+const HistogramKernel HISTOGRAM_KERNEL = selectHistogramKernel();
+
+std::vector<HistogramKernel> availableHistogramKernels() {
+    std::vector<HistogramKernel> kernels = {{histogramMultiTable, "8 таблиц, развёрнутый"}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) kernels.push_back({histogramAvx2, "AVX2 + 8 таблиц"});
+#endif
+    return kernels;
+}
+
+// ======================== Ядра однопроходного сканирования ========================
+
+void TargetCountScan::State::process(std::span<const unsigned char> data) {
+    scan_target_bytes(data, result, [](const unsigned char*, uint64_t) {});
+}
+
+void TargetCountScan::State::merge_next(const IKernelState& next) {
+    result = merge_results(result, static_cast<const State&>(next).result);
+}
+
+void HistogramScan::State::process(std::span<const unsigned char> data) {
+    HISTOGRAM_KERNEL.fn(data.data(), data.size(), counts.data());
+}
+
+void HistogramScan::State::merge_next(const IKernelState& next) {
+    const auto& other = static_cast<const State&>(next);
+    for (size_t s = 0; s < SYMBOLS; ++s) {
+        counts[s] += other.counts[s];
+    }
+}
+
+void BigramScan::State::process(std::span<const unsigned char> data) {
+    if (data.empty()) return;
+
+    const unsigned char* p = data.data();
+    if (bytes == 0) {
+        first = p[0];
+    } else {
+        ++table[(last << 8) | p[0]];  // пара на стыке с предыдущим буфером
+    }
+    for (size_t i = 1; i < data.size(); ++i) {
+        ++table[(p[i - 1] << 8) | p[i]];
+    }
+
+    last = p[data.size() - 1];
+    bytes += data.size();
+}
+
+void BigramScan::State::merge_next(const IKernelState& next) {
+    const auto& other = static_cast<const State&>(next);
+    if (other.bytes == 0) return;
+
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] += other.table[i];
+    }
+    if (bytes == 0) {
+        first = other.first;
+    } else {
+        ++table[(last << 8) | other.first];  // пара на стыке участков
+    }
+    last = other.last;
+    bytes += other.bytes;
+}
+
+// Вхождения шаблона, которые начинаются в left и заканчиваются в right (left + right непрерывны)
+static uint64_t count_spanning(const std::string& pattern, const std::string& left, std::string_view right) {
+    std::string joined = left;
+    joined.append(right);
+
+    uint64_t found = 0;
+    for (size_t start = 0; start < left.size(); ++start) {
+        if (start + pattern.size() > left.size() && start + pattern.size() <= joined.size() &&
+            joined.compare(start, pattern.size(), pattern) == 0) {
+            ++found;
+        }
+    }
+    return found;
+}
+
+// Последние keep байт строки a + b
+static std::string keep_suffix(std::string a, std::string_view b, size_t keep) {
+    a.append(b);
+    return a.size() > keep ? a.substr(a.size() - keep) : a;
+}
+
+void PatternScan::State::process(std::span<const unsigned char> data) {
+    if (pattern.empty() || data.empty()) return;
+
+    std::string_view view(reinterpret_cast<const char*>(data.data()), data.size());
+    const size_t overlap = pattern.size() - 1;
+
+    // Вхождения, разрезанные границей с предыдущим буфером
+    matches += count_spanning(pattern, tail, view.substr(0, std::min(overlap, view.size())));
+
+    // Вхождения целиком внутри буфера (перекрывающиеся тоже считаются)
+    for (size_t pos = view.find(pattern); pos != std::string_view::npos; pos = view.find(pattern, pos + 1)) {
+        ++matches;
+    }
+
+    if (head.size() < overlap) {
+        head.append(view.substr(0, overlap - head.size()));
+    }
+    tail = keep_suffix(std::move(tail), view, overlap);
+    bytes += data.size();
+}
+
+void PatternScan::State::merge_next(const IKernelState& next) {
+    const auto& other = static_cast<const State&>(next);
+    if (pattern.empty() || other.bytes == 0) return;
+
+    const size_t overlap = pattern.size() - 1;
+    matches += count_spanning(pattern, tail, other.head) + other.matches;
+
+    if (head.size() < overlap) {
+        head.append(other.head.substr(0, overlap - head.size()));
+    }
+    tail = keep_suffix(std::move(tail), other.tail, overlap);
+    bytes += other.bytes;
+}
+
+// ======================== Движок ========================
+
+std::vector<std::unique_ptr<IKernelState>> run_composite_scan(
+    const std::string& file_path, const std::vector<const IScanKernel*>& kernels,
+    unsigned int num_threads, ScanStats* stats) {
+
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open file: " << file_path << '\n';
+        return {};
+    }
+
+    const uint64_t file_size = static_cast<uint64_t>(lseek(fd, 0, SEEK_END));
+    num_threads = std::max(1u, num_threads);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // states[t][k] - состояние ядра k в потоке t
+    std::vector<std::vector<std::unique_ptr<IKernelState>>> states(num_threads);
+    for (auto& per_thread : states) {
+        for (const IScanKernel* kernel : kernels) {
+            per_thread.push_back(kernel->make_state());
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Ошибка или преждевременный конец файла в любом участке: склеивать неполные
+    // состояния нельзя - межучастковые совпадения и биграммы будут неверны
+    std::atomic<int> read_error{0};
+
+    auto worker = [&](unsigned int t) {
+        uint64_t offset = file_size * t / num_threads;
+        const uint64_t end = file_size * (t + 1) / num_threads;
+        std::vector<unsigned char> buffer(SCAN_BUFFER_SIZE);
+
+        while (offset < end) {
+            size_t to_read = static_cast<size_t>(std::min<uint64_t>(buffer.size(), end - offset));
+            ssize_t got = pread(fd, buffer.data(), to_read, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) {
+                int expected = 0;
+                read_error.compare_exchange_strong(expected, got < 0 ? errno : EIO);
+                return;
+            }
+            if (read_error.load(std::memory_order_relaxed) != 0) return;
+
+            std::span<const unsigned char> data(buffer.data(), static_cast<size_t>(got));
+            for (auto& state : states[t]) {
+                state->process(data);
+            }
+            offset += got;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    close(fd);
+
+    if (int error = read_error.load()) {
+        std::cerr << "Cannot read file: " << file_path << ": " << std::strerror(error) << '\n';
+        return {};
+    }
+
+    // Сведение по порядку участков: состояние потока t присоединяется к сумме потоков 0..t-1
+    std::vector<std::unique_ptr<IKernelState>> merged = std::move(states[0]);
+    for (unsigned int t = 1; t < num_threads; ++t) {
+        for (size_t k = 0; k < kernels.size(); ++k) {
+            merged[k]->merge_next(*states[t][k]);
+        }
+    }
+
+    if (stats) {
+        stats->bytes = file_size;
+        stats->threads = num_threads;
+        stats->elapsed_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+    return merged;
+}
@@ -0,0 +1,230 @@
+#ifndef SCAN_ENGINE_H
+#define SCAN_ENGINE_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Общий движок сканирования файлов для main.cpp и pz_1:
+// классификатор целевых байтов, ядра гистограммы и однопроходное сканирование
+// несколькими ядрами с собственным состоянием на поток.
+
+// ======================== Целевые байты (CR/LF/пробел) ========================
+
+const unsigned char TARGET_BYTE1 = 0x0a;
+const unsigned char TARGET_BYTE2 = 0x0d;
+const unsigned char TARGET_BYTE3 = 0x20;
+
+// Структура результатов
+struct CountResult {
+    uint64_t count_0a;
+    uint64_t count_0d;
+    uint64_t count_20;
+    uint64_t count_group;
+    size_t queue_size;
+
+    // Состояние на границах участка: нужно, чтобы не терять CRLF, разрезанный между потоками
+    size_t bytes_scanned = 0;
+    bool first_is_0a = false;
+    bool last_is_0d = false;
+};
+
+// Объединение результатов соседних участков (a расположен в файле непосредственно перед b).
+// Если a заканчивается на 0x0d, а b начинается с 0x0a - это ещё одна группа CRLF.
+CountResult merge_results(const CountResult& a, const CountResult& b);
+
+// Маски совпадений для блока из 64 байт: бит i соответствует байту i блока
+struct ByteMasks {
+    uint64_t lf;
+    uint64_t cr;
+    uint64_t sp;
+};
+
+const size_t CLASSIFY_BLOCK = 64;
+
+using ClassifyFn = ByteMasks (*)(const unsigned char*);
+
+struct Classifier {
+    ClassifyFn classify;
+    const char* name;
+};
+
+// Реализация, выбранная при запуске по возможностям процессора (AVX-512/AVX2/SSE2/scalar)
+extern const Classifier CLASSIFIER;
+
+// Все реализации, которые поддерживает процессор (для сверки между собой)
+std::vector<Classifier> available_classifiers();
+
+// Скалярный вариант: используется как запасной и для хвоста короче 64 байт
+ByteMasks classify_scalar(const unsigned char* p, size_t len);
+
+// Учёт масок одного блока; result.last_is_0d - был ли 0x0d последним байтом перед блоком
+inline void count_masks(const ByteMasks& m, size_t len, CountResult& result) {
+    result.count_0a += std::popcount(m.lf);
+    result.count_0d += std::popcount(m.cr);
+    result.count_20 += std::popcount(m.sp);
+
+    uint64_t cr_before = (m.cr << 1) | static_cast<uint64_t>(result.last_is_0d);
+    result.count_group += std::popcount(m.lf & cr_before);
+    result.last_is_0d = (m.cr >> (len - 1)) & 1;
+}
+
+// Сканирование непрерывного участка. result служит и накопителем, и состоянием между
+// вызовами, поэтому участок можно подавать по частям (буферами) без потери CRLF.
+// on_matches(block, mask) вызывается для блоков, где найден хотя бы один целевой байт
+template<typename OnMatches>
+void scan_target_bytes(std::span<const unsigned char> data, CountResult& result, OnMatches&& on_matches) {
+    if (data.empty()) return;
+
+    if (result.bytes_scanned == 0) {
+        result.first_is_0a = data[0] == TARGET_BYTE1;
+    }
+
+    const unsigned char* p = data.data();
+    size_t n = data.size();
+    size_t i = 0;
+
+    auto account = [&](const unsigned char* block, const ByteMasks& m, size_t len) {
+        count_masks(m, len, result);
+        uint64_t matches = m.lf | m.cr | m.sp;
+        if (matches) {
+            on_matches(block, matches);
+        }
+    };
+
+    for (; i + CLASSIFY_BLOCK <= n; i += CLASSIFY_BLOCK) {
+        account(p + i, CLASSIFIER.classify(p + i), CLASSIFY_BLOCK);
+    }
+    if (i < n) {
+        account(p + i, classify_scalar(p + i, n - i), n - i);
+    }
+
+    result.bytes_scanned += n;
+}
+
+// ======================== Ядра гистограммы ========================
+
+constexpr size_t SYMBOLS = 256;
+
+// Ядро добавляет частоты байтов data[0..len) к counts[256]
+using HistogramFn = void (*)(const unsigned char* data, size_t len, uint64_t* counts);
+
+struct HistogramKernel {
+    HistogramFn fn;
+    const char* name;
+};
+
+// Эталон: одна таблица, как в исходном countFilePart
+void histogramScalar(const unsigned char* data, size_t len, uint64_t* counts);
+
+// 8 чередующихся таблиц, развёрнутый цикл по 8-байтовым словам
+void histogramMultiTable(const unsigned char* data, size_t len, uint64_t* counts);
+
+// Ядро, выбранное при запуске
+extern const HistogramKernel HISTOGRAM_KERNEL;
+
+// Все ускоренные ядра, которые поддерживает процессор (без эталона)
+std::vector<HistogramKernel> availableHistogramKernels();
+
+// ======================== Однопроходное сканирование ========================
+
+// Состояние ядра для одного непрерывного участка файла
+struct IKernelState {
+    // Обработка очередного буфера участка (буферы приходят по порядку)
+    virtual void process(std::span<const unsigned char> data) = 0;
+    // Присоединение состояния участка, идущего в файле сразу за этим
+    virtual void merge_next(const IKernelState& next) = 0;
+    virtual ~IKernelState() = default;
+};
+
+// Ядро сканирования: создаёт независимое состояние для каждого потока
+struct IScanKernel {
+    virtual std::unique_ptr<IKernelState> make_state() const = 0;
+    virtual const char* name() const = 0;
+    virtual ~IScanKernel() = default;
+};
+
+// Количество CR, LF, пробелов и групп CRLF
+struct TargetCountScan : IScanKernel {
+    struct State : IKernelState {
+        CountResult result = {0, 0, 0, 0, 0};
+        void process(std::span<const unsigned char> data) override;
+        void merge_next(const IKernelState& next) override;
+    };
+
+    std::unique_ptr<IKernelState> make_state() const override { return std::make_unique<State>(); }
+    const char* name() const override { return "target bytes"; }
+};
+
+// Полная гистограмма 256 значений байта
+struct HistogramScan : IScanKernel {
+    struct State : IKernelState {
+        std::array<uint64_t, SYMBOLS> counts{};
+        void process(std::span<const unsigned char> data) override;
+        void merge_next(const IKernelState& next) override;
+    };
+
+    std::unique_ptr<IKernelState> make_state() const override { return std::make_unique<State>(); }
+    const char* name() const override { return "histogram"; }
+};
+
+// Таблица пар соседних байтов: индекс (первый << 8) | второй
+struct BigramScan : IScanKernel {
+    struct State : IKernelState {
+        std::vector<uint64_t> table = std::vector<uint64_t>(SYMBOLS * SYMBOLS);
+        uint64_t bytes = 0;
+        unsigned char first = 0;
+        unsigned char last = 0;
+        void process(std::span<const unsigned char> data) override;
+        void merge_next(const IKernelState& next) override;
+    };
+
+    std::unique_ptr<IKernelState> make_state() const override { return std::make_unique<State>(); }
+    const char* name() const override { return "bigrams"; }
+};
+
+// Число (в том числе перекрывающихся) вхождений шаблона
+class PatternScan : public IScanKernel {
+private:
+    std::string pattern;
+
+public:
+    struct State : IKernelState {
+        std::string pattern;  // своя копия: состояние может пережить ядро
+        uint64_t matches = 0;
+        uint64_t bytes = 0;
+        std::string head;  // первые pattern.size() - 1 байт участка
+        std::string tail;  // последние pattern.size() - 1 байт участка
+
+        explicit State(std::string pattern) : pattern(std::move(pattern)) {}
+        void process(std::span<const unsigned char> data) override;
+        void merge_next(const IKernelState& next) override;
+    };
+
+    explicit PatternScan(std::string pattern) : pattern(std::move(pattern)) {}
+
+    std::unique_ptr<IKernelState> make_state() const override { return std::make_unique<State>(pattern); }
+    const char* name() const override { return "pattern"; }
+};
+
+struct ScanStats {
+    uint64_t bytes = 0;
+    unsigned int threads = 0;
+    double elapsed_ms = 0;
+};
+
+// Один проход по файлу: каждый поток читает свой непрерывный участок буферами через pread
+// и прогоняет каждый буфер через все ядра, пока тот ещё в кэше. Состояния потоков затем
+// сводятся по порядку участков. Возвращает итоговое состояние для каждого ядра
+// (в порядке kernels) или пустой вектор, если файл не удалось открыть или прочитать целиком
+std::vector<std::unique_ptr<IKernelState>> run_composite_scan(
+    const std::string& file_path, const std::vector<const IScanKernel*>& kernels,
+    unsigned int num_threads, ScanStats* stats = nullptr);
+
+#endif //SCAN_ENGINE_H